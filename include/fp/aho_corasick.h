@@ -0,0 +1,358 @@
+/**
+ * @file aho_corasick.h
+ * @brief Search for many patterns at once (Aho-Corasick automaton)
+ *
+ * Looking for each keyword of a large list with fp_string_view_find (or rewriting them one at a time with
+ * fp_string_replace_inplace) walks the haystack once per keyword. An automaton built from all of the keywords
+ * finds every occurrence of every one of them in a single pass, one table lookup per byte, no matter how
+ * many keywords there are.
+ *
+ * The automaton is a fully resolved DFA: bytes are first mapped to equivalence classes (every byte which does
+ * not appear in any pattern shares one class), and the transitions are stored as one flat
+ * state * class_count + class table in a dynamic array, so the search loop never chases failure links.
+ *
+ * @section example_aho_corasick Aho-Corasick Usage
+ * @code
+ * fp_dynarray(fp_string_view) keywords = NULL;
+ * fpda_push_back(keywords, fp_string_view_from_literal("error"));
+ * fpda_push_back(keywords, fp_string_view_from_literal("warning"));
+ * struct fp_aho_corasick ac = fp_aho_corasick_create(keywords);
+ *
+ * fp_dynarray(struct fp_aho_corasick_match) hits = fp_aho_corasick_find_all(&ac, log);
+ * fpda_iterate(hits) printf("%s at %zu\n", i->pattern == 0 ? "error" : "warning", i->offset);
+ *
+ * fp_string_view replacements[] = {fp_string_view_from_literal("E"), fp_string_view_from_literal("W")};
+ * fp_string short_log = fp_string_view_replace_all_multi(log, &ac, replacements);
+ *
+ * fp_string_free(short_log);
+ * fpda_free(hits);
+ * fp_aho_corasick_free(&ac);
+ * fpda_free(keywords);
+ * @endcode
+ */
+
+#ifndef __LIB_FAT_POINTER_AHO_CORASICK_H__
+#define __LIB_FAT_POINTER_AHO_CORASICK_H__
+
+#include "string.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Marks the absence of a pattern (or, while building, of a transition)
+/// @internal
+#define __FP_AHO_CORASICK_NONE UINT32_MAX
+
+/**
+ * @brief Multi pattern search automaton
+ *
+ * Create with fp_aho_corasick_create and destroy with fp_aho_corasick_free. The automaton copies nothing but
+ * the pattern lengths, the patterns themselves do not need to outlive it.
+ */
+struct fp_aho_corasick {
+	uint16_t byte_classes[256];              ///< Equivalence class of every byte (0 for bytes not in any pattern)
+	size_t class_count;                      ///< Number of equivalence classes (the width of a transition row)
+	fp_dynarray(uint32_t) transitions;       ///< Next state, indexed by state * class_count + class
+	fp_dynarray(uint32_t) state_pattern;     ///< Pattern ending in each state (__FP_AHO_CORASICK_NONE if none)
+	fp_dynarray(uint32_t) first_output;      ///< First state reporting a match when reaching each state (0 if none)
+	fp_dynarray(uint32_t) output_link;       ///< Next state reporting a match after each reporting state (0 if none)
+	fp_dynarray(size_t) pattern_lengths;     ///< Length of every pattern, indexed like the pattern array
+};
+
+/**
+ * @brief Occurrence of a pattern found by an Aho-Corasick automaton
+ */
+struct fp_aho_corasick_match {
+	size_t pattern; ///< Index of the pattern in the array the automaton was created from
+	size_t offset;  ///< Offset of the first byte of the occurrence in the haystack
+	size_t length;  ///< Length of the occurrence (the length of the pattern)
+};
+
+/**
+ * @brief Build an automaton searching for all of the given patterns at once
+ * @param patterns Patterns to search for (empty patterns never match, if a pattern appears several times only its first index is reported)
+ * @return Automaton (must be freed with fp_aho_corasick_free)
+ *
+ * @code
+ * fp_dynarray(fp_string_view) keywords = fp_string_split(keyword_file, "\n");
+ * struct fp_aho_corasick ac = fp_aho_corasick_create(keywords);
+ * // ...
+ * fp_aho_corasick_free(&ac);
+ * @endcode
+ */
+struct fp_aho_corasick fp_aho_corasick_create(const fp_dynarray(fp_string_view) patterns) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	FP_ZONE_SCOPED;
+	struct fp_aho_corasick ac;
+	memset(&ac, 0, sizeof(ac));
+	size_t pattern_count = fpda_size(patterns);
+
+	// Every byte used by a pattern gets its own class, all others share class 0 (which always leads back to the root)
+	ac.class_count = 1;
+	for(size_t p = 0; p < pattern_count; ++p)
+		for(size_t i = 0; i < fp_view_size(patterns[p]); ++i) {
+			uint8_t byte = fp_view_data(uint8_t, patterns[p])[i];
+			if(ac.byte_classes[byte] == 0) ac.byte_classes[byte] = (uint16_t)ac.class_count++;
+		}
+	size_t C = ac.class_count;
+
+	// Build the trie
+	fpda_grow_and_initialize(ac.transitions, C, __FP_AHO_CORASICK_NONE);
+	fpda_push_back(ac.state_pattern, __FP_AHO_CORASICK_NONE);
+	fpda_reserve(ac.pattern_lengths, pattern_count);
+	for(size_t p = 0; p < pattern_count; ++p) {
+		size_t length = fp_view_size(patterns[p]);
+		fpda_push_back(ac.pattern_lengths, length);
+		if(length == 0) continue;
+
+		uint32_t state = 0;
+		for(size_t i = 0; i < length; ++i) {
+			size_t edge = state * C + ac.byte_classes[fp_view_data(uint8_t, patterns[p])[i]];
+			if(ac.transitions[edge] == __FP_AHO_CORASICK_NONE) {
+				uint32_t added = (uint32_t)fpda_size(ac.state_pattern);
+				fpda_grow_and_initialize(ac.transitions, C, __FP_AHO_CORASICK_NONE);
+				fpda_push_back(ac.state_pattern, __FP_AHO_CORASICK_NONE);
+				ac.transitions[edge] = added;
+			}
+			state = ac.transitions[edge];
+		}
+		if(ac.state_pattern[state] == __FP_AHO_CORASICK_NONE)
+			ac.state_pattern[state] = (uint32_t)p;
+	}
+
+	// Breadth first: compute the failure links and fill in the missing transitions from the (shallower, thus finished) failure state
+	size_t state_count = fpda_size(ac.state_pattern);
+	fp_dynarray(uint32_t) fail = NULL;
+	fp_dynarray(uint32_t) queue = NULL;
+	fpda_grow_and_initialize(fail, state_count, 0);
+	fpda_reserve(queue, state_count);
+	fpda_grow_and_initialize(ac.first_output, state_count, 0);
+	fpda_grow_and_initialize(ac.output_link, state_count, 0);
+	for(size_t c = 0; c < C; ++c) {
+		uint32_t* child = ac.transitions + c;
+		if(*child == __FP_AHO_CORASICK_NONE) *child = 0;
+		else fpda_push_back(queue, *child);
+	}
+	for(size_t head = 0; head < fpda_size(queue); ++head) {
+		uint32_t state = queue[head];
+		ac.output_link[state] = ac.first_output[fail[state]];
+		ac.first_output[state] = ac.state_pattern[state] != __FP_AHO_CORASICK_NONE ? state : ac.output_link[state];
+
+		for(size_t c = 0; c < C; ++c) {
+			uint32_t* child = ac.transitions + state * C + c;
+			uint32_t fallback = ac.transitions[fail[state] * C + c];
+			if(*child == __FP_AHO_CORASICK_NONE) *child = fallback;
+			else {
+				fail[*child] = fallback;
+				fpda_push_back(queue, *child);
+			}
+		}
+	}
+
+	fpda_free(queue);
+	fpda_free(fail);
+	return ac;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Free the memory owned by an automaton
+ * @param ac Automaton created by fp_aho_corasick_create (left zeroed)
+ */
+inline static void fp_aho_corasick_free(struct fp_aho_corasick* ac) FP_NOEXCEPT {
+	fpda_free(ac->transitions);
+	fpda_free(ac->state_pattern);
+	fpda_free(ac->first_output);
+	fpda_free(ac->output_link);
+	fpda_free(ac->pattern_lengths);
+	memset(ac, 0, sizeof(*ac));
+}
+
+/**
+ * @brief Get the number of patterns an automaton was created from
+ * @param ac Automaton created by fp_aho_corasick_create
+ */
+inline static size_t fp_aho_corasick_pattern_count(const struct fp_aho_corasick* ac) FP_NOEXCEPT {
+	return fpda_size(ac->pattern_lengths);
+}
+
+/**
+ * @brief Find the first (earliest ending) occurrence of any pattern
+ * @param ac Automaton created by fp_aho_corasick_create
+ * @param haystack Text to search
+ * @param start Offset to start searching from
+ * @param match Filled with the occurrence if one is found (the longest pattern if several end at the same byte)
+ * @return True if any pattern occurs in the haystack at or after start
+ */
+inline static bool fp_aho_corasick_find(const struct fp_aho_corasick* ac, const fp_string_view haystack, size_t start, struct fp_aho_corasick_match* match) FP_NOEXCEPT {
+	FP_ZONE_SCOPED_AGGRO;
+	const uint8_t* h = fp_view_data(uint8_t, haystack);
+	size_t C = ac->class_count;
+	uint32_t state = 0;
+	for(size_t i = start; i < fp_view_size(haystack); ++i) {
+		state = ac->transitions[state * C + ac->byte_classes[h[i]]];
+		uint32_t out = ac->first_output[state];
+		if(out) {
+			match->pattern = ac->state_pattern[out];
+			match->length = ac->pattern_lengths[match->pattern];
+			match->offset = i + 1 - match->length;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Find every (possibly overlapping) occurrence of every pattern, appending them to a dynamic array
+ * @param ac Automaton created by fp_aho_corasick_create
+ * @param haystack Text to search
+ * @param out Dynamic array the matches are appended to (ordered by the offset they end at)
+ * @return The (possibly reallocated) output array
+ *
+ * @code
+ * fp_dynarray(struct fp_aho_corasick_match) hits = NULL;
+ * for(each line) {
+ *     fpda_clear(hits);
+ *     fp_aho_corasick_find_all_inplace(&ac, line, &hits);
+ *     // ...
+ * }
+ * fpda_free(hits);
+ * @endcode
+ */
+inline static fp_dynarray(struct fp_aho_corasick_match) fp_aho_corasick_find_all_inplace(const struct fp_aho_corasick* ac, const fp_string_view haystack, fp_dynarray(struct fp_aho_corasick_match)* out) FP_NOEXCEPT {
+	FP_ZONE_SCOPED;
+	const uint8_t* h = fp_view_data(uint8_t, haystack);
+	size_t C = ac->class_count;
+	uint32_t state = 0;
+	for(size_t i = 0; i < fp_view_size(haystack); ++i) {
+		state = ac->transitions[state * C + ac->byte_classes[h[i]]];
+		for(uint32_t reporting = ac->first_output[state]; reporting; reporting = ac->output_link[reporting]) {
+			struct fp_aho_corasick_match match;
+			match.pattern = ac->state_pattern[reporting];
+			match.length = ac->pattern_lengths[match.pattern];
+			match.offset = i + 1 - match.length;
+			fpda_push_back(*out, match);
+		}
+	}
+	return *out;
+}
+
+/**
+ * @brief Find every (possibly overlapping) occurrence of every pattern
+ * @param ac Automaton created by fp_aho_corasick_create
+ * @param haystack Text to search
+ * @return Dynamic array of matches ordered by the offset they end at (must be freed, NULL if nothing matched)
+ */
+inline static fp_dynarray(struct fp_aho_corasick_match) fp_aho_corasick_find_all(const struct fp_aho_corasick* ac, const fp_string_view haystack) FP_NOEXCEPT {
+	fp_dynarray(struct fp_aho_corasick_match) out = NULL;
+	return fp_aho_corasick_find_all_inplace(ac, haystack, &out);
+}
+
+/**
+ * @brief Count the (possibly overlapping) occurrences of every pattern
+ * @param ac Automaton created by fp_aho_corasick_create
+ * @param haystack Text to search
+ * @return Total number of occurrences
+ */
+inline static size_t fp_aho_corasick_count(const struct fp_aho_corasick* ac, const fp_string_view haystack) FP_NOEXCEPT {
+	const uint8_t* h = fp_view_data(uint8_t, haystack);
+	size_t C = ac->class_count, count = 0;
+	uint32_t state = 0;
+	for(size_t i = 0; i < fp_view_size(haystack); ++i) {
+		state = ac->transitions[state * C + ac->byte_classes[h[i]]];
+		for(uint32_t reporting = ac->first_output[state]; reporting; reporting = ac->output_link[reporting])
+			++count;
+	}
+	return count;
+}
+
+/**
+ * @brief Order matches by offset, longer patterns first
+ * @internal
+ */
+inline static int __fp_aho_corasick_match_compare(const void* a, const void* b) FP_NOEXCEPT {
+	const struct fp_aho_corasick_match* x = (const struct fp_aho_corasick_match*)a;
+	const struct fp_aho_corasick_match* y = (const struct fp_aho_corasick_match*)b;
+	if(x->offset != y->offset) return x->offset < y->offset ? -1 : 1;
+	return x->length > y->length ? -1 : x->length < y->length;
+}
+
+/**
+ * @brief Replace every occurrence of every pattern (returns new string)
+ * @param view Text to rewrite
+ * @param ac Automaton created by fp_aho_corasick_create
+ * @param replacements Replacement of each pattern (indexed like the pattern array, must have fp_aho_corasick_pattern_count elements)
+ * @return New string with every match replaced (must be freed)
+ *
+ * Where matches overlap the leftmost one wins, and among the matches starting at the same offset the longest
+ * one does. Replacements are never searched again. The result is written into a single allocation.
+ *
+ * @code
+ * // keywords: "he", "she", "hers"
+ * fp_string_view with[] = {fp_string_view_from_literal("1"), fp_string_view_from_literal("2"), fp_string_view_from_literal("3")};
+ * fp_string out = fp_string_view_replace_all_multi(fp_string_view_from_literal("ushers"), &ac, with);
+ * printf("%s\n", out); // "u2rs"
+ * fp_string_free(out);
+ * @endcode
+ */
+fp_string fp_string_view_replace_all_multi(const fp_string_view view, const struct fp_aho_corasick* ac, const fp_string_view* replacements) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	FP_ZONE_SCOPED;
+	fp_dynarray(struct fp_aho_corasick_match) matches = fp_aho_corasick_find_all(ac, view);
+	size_t match_count = fpda_size(matches);
+	if(match_count == 0) return fp_string_view_make_dynamic(view);
+
+	// Matches come out ordered by where they end, greedily keeping the leftmost-longest ones needs them ordered by where they start
+	qsort(matches, match_count, sizeof(struct fp_aho_corasick_match), __fp_aho_corasick_match_compare);
+	size_t kept = 0, size = fp_view_size(view), covered = 0;
+	for(size_t i = 0; i < match_count; ++i) {
+		if(matches[i].offset < covered) continue;
+		matches[kept++] = matches[i];
+		covered = matches[i].offset + matches[i].length;
+		size = size - matches[i].length + fp_view_size(replacements[matches[i].pattern]);
+	}
+
+	fp_string out = NULL;
+	fpda_resize(out, size);
+	const char* in = fp_view_data(char, view);
+	size_t read = 0, written = 0;
+	for(size_t i = 0; i < kept; ++i) {
+		const struct fp_aho_corasick_match* m = matches + i;
+		memcpy(out + written, in + read, m->offset - read);
+		written += m->offset - read;
+		fp_string_view with = replacements[m->pattern];
+		memcpy(out + written, fp_view_data(char, with), fp_view_size(with));
+		written += fp_view_size(with);
+		read = m->offset + m->length;
+	}
+	memcpy(out + written, in + read, fp_view_size(view) - read);
+	out[size] = 0;
+
+	fpda_free(matches);
+	return out;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Replace every occurrence of every pattern (returns new string)
+ * @param str Text to rewrite
+ * @param ac Automaton created by fp_aho_corasick_create
+ * @param replacements Replacement of each pattern (indexed like the pattern array)
+ * @return New string with every match replaced (must be freed)
+ */
+inline static fp_string fp_string_replace_all_multi(const fp_string str, const struct fp_aho_corasick* ac, const fp_string_view* replacements) FP_NOEXCEPT {
+	return fp_string_view_replace_all_multi(fp_string_to_view_const(str), ac, replacements);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_AHO_CORASICK_H__
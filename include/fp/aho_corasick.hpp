@@ -0,0 +1,71 @@
+/**
+ * @file aho_corasick.hpp
+ * @brief C++ wrapper for multi pattern (Aho-Corasick) search
+ *
+ * @code{.cpp}
+ * fp::raii::dynarray<fp::string_view> keywords;
+ * keywords.push_back("error");
+ * keywords.push_back("warning");
+ * fp::aho_corasick ac(keywords);
+ * fp::raii::dynarray<fp::aho_corasick_match> hits = ac.find_all(log); // find_all returns a new array, which must be freed
+ * for(auto& hit: hits)
+ *     std::cout << hit.pattern << " at " << hit.offset << "\n";
+ * @endcode
+ */
+
+#pragma once
+
+#include "string.hpp"
+#include "aho_corasick.h"
+#include <optional>
+
+namespace fp {
+	using aho_corasick_match = fp_aho_corasick_match;
+
+	/**
+	 * @brief Owning wrapper around an fp_aho_corasick automaton
+	 *
+	 * The automaton is freed when the wrapper is destroyed.
+	 */
+	struct aho_corasick {
+		fp_aho_corasick raw = {};
+
+		aho_corasick() noexcept = default;
+
+		/**
+		 * @brief Build an automaton searching for all of the given patterns at once
+		 * @param patterns Patterns to search for (matches report indices into this array)
+		 */
+		aho_corasick(const dynarray<string_view> patterns) noexcept : raw(fp_aho_corasick_create((const fp_string_view*)patterns.raw)) {}
+		aho_corasick(const aho_corasick&) = delete;
+		aho_corasick(aho_corasick&& o) noexcept : raw(std::exchange(o.raw, {})) {}
+		aho_corasick& operator=(const aho_corasick&) = delete;
+		aho_corasick& operator=(aho_corasick&& o) noexcept { std::swap(raw, o.raw); return *this; }
+		~aho_corasick() noexcept { fp_aho_corasick_free(&raw); }
+
+		inline size_t pattern_count() const noexcept { return fp_aho_corasick_pattern_count(&raw); }
+
+		inline std::optional<aho_corasick_match> find(const string_view haystack, size_t start = 0) const noexcept {
+			aho_corasick_match match;
+			if(fp_aho_corasick_find(&raw, haystack, start, &match)) return match;
+			return {};
+		}
+		inline bool contains(const string_view haystack, size_t start = 0) const noexcept { return find(haystack, start).has_value(); }
+		inline dynarray<aho_corasick_match> find_all(const string_view haystack) const noexcept { return fp_aho_corasick_find_all(&raw, haystack); }
+		inline dynarray<aho_corasick_match>& find_all(const string_view haystack, dynarray<aho_corasick_match>& out) const noexcept {
+			fp_aho_corasick_find_all_inplace(&raw, haystack, &out.raw);
+			return out;
+		}
+		inline size_t count(const string_view haystack) const noexcept { return fp_aho_corasick_count(&raw, haystack); }
+
+		/**
+		 * @brief Replace every occurrence of every pattern (leftmost-longest, see fp_string_view_replace_all_multi)
+		 * @param haystack Text to rewrite
+		 * @param replacements Replacement of each pattern (indexed like the pattern array)
+		 * @return New string with every match replaced (must be freed)
+		 */
+		inline string replace_all(const string_view haystack, const string_view* replacements) const noexcept {
+			return string{fp_string_view_replace_all_multi(haystack, &raw, (const fp_string_view*)replacements)};
+		}
+	};
+}
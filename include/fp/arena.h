@@ -0,0 +1,290 @@
+/**
+ * @file arena.h
+ * @brief Bump allocator which fat pointers, dynamic arrays, strings and hash tables can be carved out of
+ *
+ * An arena hands out memory by bumping a pointer through large blocks, and gives all of it back at once
+ * when it is reset or released. Since every fat pointer remembers the allocator that created it, arena
+ * backed containers can be used with the regular API... and fp_free/fpda_free on them is (nearly) free.
+ *
+ * The most recent allocation in an arena can be grown or shrunk in place, so a dynamic array or string
+ * which is being built up while nothing else is allocated never has to be copied.
+ *
+ * @section example_arena Arena Usage
+ * @code
+ * struct fp_arena* arena = fp_arena_create(0);
+ *
+ * for(each request) {
+ *     const struct fp_allocator* previous = fp_set_thread_allocator(fp_arena_allocator(arena));
+ *     fp_string line = fp_string_format("%s: %d", name, value);        // From the arena
+ *     fp_dynarray(fp_string_view) parts = fp_string_split(line, " "); // From the arena
+ *     // ...
+ *     fp_set_thread_allocator(previous);
+ *     fp_arena_reset(arena); // Everything allocated above is gone, no need to free it
+ * }
+ *
+ * fp_arena_release(arena);
+ * @endcode
+ *
+ * @warning Containers allocated from an arena must not be used (or freed) after the arena is reset or released.
+ */
+
+#ifndef __LIB_FAT_POINTER_ARENA_H__
+#define __LIB_FAT_POINTER_ARENA_H__
+
+#include "pointer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FP_ARENA_DEFAULT_BLOCK_SIZE
+/// @brief Size in bytes of the first block an arena allocates (when 0 is passed to fp_arena_create)
+#define FP_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+#endif
+
+#ifndef FP_ARENA_ALIGNMENT
+/// @brief Alignment of every allocation made from an arena
+#define FP_ARENA_ALIGNMENT 16
+#endif
+
+/**
+ * @brief Header of a block of memory owned by an arena
+ *
+ * Layout:
+ * [__FatArenaBlock][allocations...]
+ * @internal
+ */
+struct __FatArenaBlock {
+	struct __FatArenaBlock* previous; ///< Block allocated before this one (NULL for the first)
+	size_t size;                      ///< Size in bytes of the block (including this header)
+};
+
+/**
+ * @brief Bump allocator
+ *
+ * Create with fp_arena_create, and destroy with fp_arena_release.
+ */
+struct fp_arena {
+	struct fp_allocator allocator;   ///< Allocator handle (state points back at this arena)
+	struct __FatArenaBlock* block;   ///< Most recently allocated block
+	uint8_t* top;                    ///< Next free byte in the current block
+	uint8_t* end;                    ///< End of the current block
+	uint8_t* last;                   ///< Most recent allocation (which can be resized in place)
+	size_t block_size;               ///< Minimum size of new blocks
+};
+
+/// @cond INTERNAL
+inline static uint8_t* __fp_arena_align(uint8_t* p) FP_NOEXCEPT {
+	return (uint8_t*)(((uintptr_t)p + FP_ARENA_ALIGNMENT - 1) & ~(uintptr_t)(FP_ARENA_ALIGNMENT - 1));
+}
+/// @endcond
+
+/**
+ * @brief Allocate a new block big enough to hold size bytes and make it the current block
+ * @internal
+ */
+bool __fp_arena_add_block(struct fp_arena* arena, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	size_t block_size = sizeof(struct __FatArenaBlock) + FP_ARENA_ALIGNMENT + size;
+	if(arena->block) block_size = FP_MAX(block_size, arena->block->size * 2); // Blocks grow geometrically
+	block_size = FP_MAX(block_size, arena->block_size);
+
+	struct __FatArenaBlock* block = (struct __FatArenaBlock*)FP_ALLOCATION_FUNCTION(NULL, block_size);
+	if(!block) return false;
+	FP_TRACE_ALLOCATION(block, block_size);
+	block->previous = arena->block;
+	block->size = block_size;
+
+	arena->block = block;
+	arena->top = ((uint8_t*)block) + sizeof(struct __FatArenaBlock);
+	arena->end = ((uint8_t*)block) + block_size;
+	arena->last = NULL;
+	return true;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Arena fp_allocator::allocate implementation
+ * @internal
+ */
+void* __fp_arena_allocate(void* state, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct fp_arena* arena = (struct fp_arena*)state;
+	uint8_t* p = __fp_arena_align(arena->top);
+	if(arena->block == NULL || p > arena->end || (size_t)(arena->end - p) < size) {
+		if(!__fp_arena_add_block(arena, size)) return NULL;
+		p = __fp_arena_align(arena->top);
+	}
+
+	arena->top = p + size;
+	arena->last = p;
+	return p;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Arena fp_allocator::reallocate implementation (resizes the most recent allocation in place)
+ * @internal
+ */
+void* __fp_arena_reallocate(void* state, void* p, size_t old_size, size_t new_size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct fp_arena* arena = (struct fp_arena*)state;
+	if(p == arena->last && (size_t)(arena->end - arena->last) >= new_size) {
+		arena->top = arena->last + new_size;
+		return p;
+	}
+	if(new_size <= old_size) return p;
+
+	void* out = __fp_arena_allocate(state, new_size);
+	if(out) memcpy(out, p, old_size);
+	return out;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Arena fp_allocator::deallocate implementation (only the most recent allocation is actually given back)
+ * @internal
+ */
+void __fp_arena_deallocate(void* state, void* p, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	(void)size;
+	struct fp_arena* arena = (struct fp_arena*)state;
+	if(p != arena->last) return;
+	arena->top = arena->last;
+	arena->last = NULL;
+}
+#else
+;
+#endif
+
+/** \addtogroup capi
+ *  @{
+ */
+
+/**
+ * @brief Create a new arena
+ * @param block_size Minimum size in bytes of the blocks the arena allocates (0 for FP_ARENA_DEFAULT_BLOCK_SIZE)
+ * @return The new arena (or NULL if it could not be allocated)
+ *
+ * Blocks are only allocated once memory is first requested from the arena.
+ *
+ * @code
+ * struct fp_arena* arena = fp_arena_create(1024 * 1024);
+ * int* data = fp_malloc_with_allocator(int, 100, fp_arena_allocator(arena));
+ * fp_arena_release(arena); // Also frees data
+ * @endcode
+ */
+struct fp_arena* fp_arena_create(size_t block_size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct fp_arena* arena = (struct fp_arena*)FP_ALLOCATION_FUNCTION(NULL, sizeof(struct fp_arena));
+	if(!arena) return NULL;
+	memset(arena, 0, sizeof(struct fp_arena));
+	arena->allocator.allocate = __fp_arena_allocate;
+	arena->allocator.reallocate = __fp_arena_reallocate;
+	arena->allocator.deallocate = __fp_arena_deallocate;
+	arena->allocator.state = arena;
+	arena->block_size = block_size ? block_size : FP_ARENA_DEFAULT_BLOCK_SIZE;
+	return arena;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Get the allocator handle of an arena
+ * @param arena The arena
+ * @return Allocator which can be passed to fp_malloc_with_allocator, fpda_malloc_with_allocator, fp_set_thread_allocator, etc...
+ */
+inline static const struct fp_allocator* fp_arena_allocator(const struct fp_arena* arena) FP_NOEXCEPT {
+	return &arena->allocator;
+}
+
+/**
+ * @brief Free everything allocated from an arena at once, keeping its memory around for reuse
+ * @param arena The arena
+ *
+ * Only the most recent (and thus largest) block is kept, once an arena has seen its peak
+ * usage it no longer needs to allocate any memory.
+ *
+ * @code
+ * for(each request) {
+ *     handle_request(arena);
+ *     fp_arena_reset(arena);
+ * }
+ * @endcode
+ */
+void fp_arena_reset(struct fp_arena* arena) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(!arena->block) return;
+	struct __FatArenaBlock* previous = arena->block->previous;
+	while(previous) {
+		struct __FatArenaBlock* next = previous->previous;
+		FP_TRACE_FREE(previous);
+		FP_ALLOCATION_FUNCTION(previous, 0);
+		previous = next;
+	}
+
+	arena->block->previous = NULL;
+	arena->top = ((uint8_t*)arena->block) + sizeof(struct __FatArenaBlock);
+	arena->last = NULL;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Free an arena and everything which was allocated from it
+ * @param arena The arena (invalid after this call)
+ */
+void fp_arena_release(struct fp_arena* arena) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(!arena) return;
+	struct __FatArenaBlock* block = arena->block;
+	while(block) {
+		struct __FatArenaBlock* previous = block->previous;
+		FP_TRACE_FREE(block);
+		FP_ALLOCATION_FUNCTION(block, 0);
+		block = previous;
+	}
+	FP_ALLOCATION_FUNCTION(arena, 0);
+}
+#else
+;
+#endif
+
+/**
+ * @brief Release an arena and set the pointer to NULL
+ * @param arena The arena
+ */
+#define fp_arena_release_and_null(arena) (fp_arena_release(arena), arena = NULL)
+
+/**
+ * @brief Get the number of bytes of the current block which are in use
+ * @param arena The arena
+ * @return Bytes in use since the last reset or block allocation
+ */
+inline static size_t fp_arena_used(const struct fp_arena* arena) FP_NOEXCEPT {
+	if(!arena->block) return 0;
+	return arena->top - (((uint8_t*)arena->block) + sizeof(struct __FatArenaBlock));
+}
+
+/** @} */
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_ARENA_H__
@@ -0,0 +1,75 @@
+/**
+ * @file arena.hpp
+ * @brief C++ wrapper for bump allocating arenas
+ *
+ * @code{.cpp}
+ * fp::arena arena;
+ * for(auto& request: requests) {
+ *     {
+ *         auto scope = arena.make_current();
+ *         fp::raii::string line = fp::string::format("{}: {}", request.name, request.value); // From the arena
+ *         // ...
+ *     }
+ *     arena.reset(); // Give everything back in one go
+ * }
+ * @endcode
+ */
+
+#pragma once
+
+#include "pointer.hpp"
+#include "arena.h"
+
+namespace fp {
+	/**
+	 * @brief Owning wrapper around an fp_arena
+	 *
+	 * The arena (and everything allocated from it) is released when the wrapper is destroyed.
+	 */
+	struct arena {
+		fp_arena* raw;
+
+		/**
+		 * @brief Create a new arena
+		 * @param block_size Minimum size in bytes of the blocks the arena allocates (0 for FP_ARENA_DEFAULT_BLOCK_SIZE)
+		 */
+		arena(size_t block_size = 0) noexcept : raw(fp_arena_create(block_size)) {}
+		arena(const arena&) = delete;
+		arena(arena&& o) noexcept : raw(std::exchange(o.raw, nullptr)) {}
+		arena& operator=(const arena&) = delete;
+		arena& operator=(arena&& o) noexcept { std::swap(raw, o.raw); return *this; }
+		~arena() noexcept { if(raw) fp_arena_release(raw); }
+
+		/**
+		 * @brief Get the allocator handle of this arena
+		 * @return Allocator which can be passed to fp::malloc, fp::dynarray::with_allocator, hash table configs, etc...
+		 */
+		inline const fp_allocator* allocator() const noexcept { return fp_arena_allocator(raw); }
+
+		/**
+		 * @brief Free everything allocated from this arena at once, keeping its memory around for reuse
+		 * @return Reference to this arena for chaining
+		 */
+		inline arena& reset() noexcept { fp_arena_reset(raw); return *this; }
+
+		/**
+		 * @brief Get the number of bytes of the current block which are in use
+		 */
+		inline size_t used() const noexcept { return fp_arena_used(raw); }
+
+		/**
+		 * @brief Make this arena the thread's default allocator until the returned scope is destroyed
+		 * @return Scope object restoring the previous default allocator on destruction
+		 *
+		 * @code{.cpp}
+		 * fp::arena arena;
+		 * {
+		 *     auto scope = arena.make_current();
+		 *     fp::raii::dynarray<int> arr;
+		 *     arr.push_back(1); // Allocated from the arena
+		 * }
+		 * @endcode
+		 */
+		[[nodiscard]] inline thread_allocator_scope make_current() const noexcept { return {allocator()}; }
+	};
+}
@@ -0,0 +1,221 @@
+/**
+ * @file csv.h
+ * @brief Zero copy CSV/TSV parser yielding string views into the original buffer
+ *
+ * The parser classifies the input 64 bytes at a time (see fp_byte_set_mask64): every delimiter and line break
+ * in a block becomes a bit of a mask, so finding the end of the next field is a bit scan rather than a loop over
+ * its characters. Quoted fields are supported ("a, b" and "say ""hi"""), their content is yielded without the
+ * surrounding quotes, and fp_csv_field_unescape can collapse doubled quotes when needed.
+ *
+ * Records end at "\n" or "\r\n", a line break at the very end of the input does not start another record.
+ *
+ * @section example_csv CSV Usage
+ * @code
+ * struct fp_csv_parser csv = fp_csv_parser_create(file_contents, ',', '"');
+ * fp_dynarray(fp_string_view) fields = NULL;
+ * while(fp_csv_parser_next_record(&csv, &fields)) {
+ *     fpda_iterate(fields) printf("[%.*s] ", (int)fp_string_view_length(*i), fp_view_data(char, *i));
+ *     printf("\n");
+ * }
+ * fpda_free(fields);
+ *
+ * // TSV usually has no quoting at all
+ * struct fp_csv_parser tsv = fp_csv_parser_create(file_contents, '\t', 0);
+ * @endcode
+ */
+
+#ifndef __LIB_FAT_POINTER_CSV_H__
+#define __LIB_FAT_POINTER_CSV_H__
+
+#include "string.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief State of a CSV/TSV parser
+ *
+ * Create with fp_csv_parser_create and advance with fp_csv_parser_next or fp_csv_parser_next_record.
+ * The parser owns no memory, the yielded fields reference the input, which must outlive them.
+ */
+struct fp_csv_parser {
+	fp_string_view input;              ///< Text being parsed
+	size_t position;                   ///< Start of the next field
+	struct fp_byte_set separators;     ///< The delimiter and the line break bytes
+	char delimiter;                    ///< Byte separating the fields of a record
+	char quote;                        ///< Byte quoting fields (0 if fields are never quoted)
+	size_t block;                      ///< Offset of the 64 byte block described by mask (SIZE_MAX if none)
+	uint64_t mask;                     ///< Separators in that block
+	bool field_pending;                ///< Whether the last field ended with a delimiter (so another one follows, even at the end)
+};
+
+/**
+ * @brief Field yielded by a CSV/TSV parser
+ */
+struct fp_csv_field {
+	fp_string_view value;  ///< Content of the field (without the quotes of quoted fields)
+	bool escaped;          ///< Whether the value contains doubled quotes (see fp_csv_field_unescape)
+	bool end_of_record;    ///< Whether this is the last field of its record
+};
+
+/**
+ * @brief Create a parser over a buffer
+ * @param input Text to parse
+ * @param delimiter Byte separating the fields of a record (usually ',' or '\t')
+ * @param quote Byte quoting fields (usually '"', or 0 to disable quoting)
+ * @return Parser to pass to fp_csv_parser_next or fp_csv_parser_next_record
+ */
+inline static struct fp_csv_parser fp_csv_parser_create(const fp_string_view input, char delimiter, char quote) FP_NOEXCEPT {
+	struct fp_csv_parser parser;
+	char separators[3] = {delimiter, '\n', '\r'};
+	parser.input = input;
+	parser.position = 0;
+	parser.separators = fp_byte_set_create(fp_string_view_literal(separators, 3));
+	parser.delimiter = delimiter;
+	parser.quote = quote;
+	parser.block = SIZE_MAX;
+	parser.mask = 0;
+	parser.field_pending = false;
+	return parser;
+}
+
+/**
+ * @brief Find the first delimiter or line break at or after an offset
+ * @return Its offset, or the size of the input if there is none
+ * @internal
+ */
+inline static size_t __fp_csv_next_separator(struct fp_csv_parser* parser, size_t from) FP_NOEXCEPT {
+	const uint8_t* data = fp_view_data(uint8_t, parser->input);
+	size_t n = fp_view_size(parser->input);
+	for(size_t base = from & ~(size_t)63; base < n; base += 64) {
+		if(base != parser->block) {
+			parser->block = base;
+			if(base + 64 <= n)
+				parser->mask = fp_byte_set_mask64(&parser->separators, data + base);
+			else { // The last partial block is classified from a padded copy
+				uint8_t tail[64] = {0};
+				memcpy(tail, data + base, n - base);
+				parser->mask = fp_byte_set_mask64(&parser->separators, tail) & (((uint64_t)1 << (n - base)) - 1);
+			}
+		}
+		uint64_t mask = parser->mask;
+		if(from > base) mask &= ~(uint64_t)0 << (from - base);
+		if(mask) return base + __fp_lowest_bit64(mask);
+	}
+	return n;
+}
+
+/**
+ * @brief Get the next field
+ * @param parser Parser created by fp_csv_parser_create
+ * @param field Filled with the next field
+ * @return False once the whole input has been parsed (field is then left untouched)
+ *
+ * Bytes between the closing quote of a quoted field and the next delimiter are ignored, an unterminated
+ * quoted field runs to the end of the input. Outside of quoted fields a lone "\r" is regular content.
+ *
+ * @code
+ * struct fp_csv_field field;
+ * size_t column = 0;
+ * while(fp_csv_parser_next(&csv, &field)) {
+ *     handle(column, field.value);
+ *     column = field.end_of_record ? 0 : column + 1;
+ * }
+ * @endcode
+ */
+inline static bool fp_csv_parser_next(struct fp_csv_parser* parser, struct fp_csv_field* field) FP_NOEXCEPT {
+	FP_ZONE_SCOPED_AGGRO;
+	const char* data = fp_view_data(char, parser->input);
+	size_t n = fp_view_size(parser->input), start = parser->position, end;
+	if(start >= n && !parser->field_pending) return false;
+
+	field->escaped = false;
+	if(parser->quote && start < n && data[start] == parser->quote) {
+		size_t close = start + 1;
+		for(;;) {
+			const char* found = (const char*)memchr(data + close, parser->quote, n - close);
+			if(found == NULL) { close = n; break; }
+			close = (size_t)(found - data);
+			if(close + 1 < n && data[close + 1] == parser->quote) {
+				field->escaped = true;
+				close += 2;
+			} else break;
+		}
+		field->value = fp_string_view_literal((char*)data + start + 1, close - start - 1);
+		end = close < n ? __fp_csv_next_separator(parser, close + 1) : n;
+		while(end < n && data[end] == '\r' && end + 1 < n && data[end + 1] != '\n')
+			end = __fp_csv_next_separator(parser, end + 1);
+	} else {
+		end = __fp_csv_next_separator(parser, start);
+		while(end < n && data[end] == '\r' && end + 1 < n && data[end + 1] != '\n')
+			end = __fp_csv_next_separator(parser, end + 1);
+		field->value = fp_string_view_literal((char*)data + start, end - start);
+	}
+
+	parser->field_pending = false;
+	if(end >= n) {
+		field->end_of_record = true;
+		parser->position = n;
+	} else if(data[end] == parser->delimiter) {
+		field->end_of_record = false;
+		parser->field_pending = true;
+		parser->position = end + 1;
+	} else { // "\n", "\r\n" or a "\r" ending the input
+		field->end_of_record = true;
+		parser->position = end + (data[end] == '\r' && end + 1 < n ? 2 : 1);
+	}
+	return true;
+}
+
+/**
+ * @brief Get every field of the next record
+ * @param parser Parser created by fp_csv_parser_create
+ * @param fields Dynamic array which is cleared and filled with the fields (reuse it between records to avoid allocating)
+ * @return False once the whole input has been parsed
+ *
+ * @note Quoted fields containing doubled quotes are yielded as is, see fp_csv_parser_next to find out which ones are.
+ */
+inline static bool fp_csv_parser_next_record(struct fp_csv_parser* parser, fp_dynarray(fp_string_view)* fields) FP_NOEXCEPT {
+	if(*fields) fpda_clear(*fields);
+	struct fp_csv_field field;
+	while(fp_csv_parser_next(parser, &field)) {
+		fpda_push_back(*fields, field.value);
+		if(field.end_of_record) return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Collapse the doubled quotes of a quoted field (returns new string)
+ * @param value Value of a field yielded by fp_csv_parser_next
+ * @param quote Quote byte the parser was created with
+ * @return New string with every pair of quotes replaced by a single one (must be freed)
+ *
+ * @code
+ * // The field "say ""hi""" is yielded as: say ""hi""
+ * if(field.escaped) {
+ *     fp_string text = fp_csv_field_unescape(field.value, '"'); // say "hi"
+ *     // ...
+ *     fp_string_free(text);
+ * }
+ * @endcode
+ */
+inline static fp_string fp_csv_field_unescape(const fp_string_view value, char quote) FP_NOEXCEPT {
+	fp_string out = fp_string_view_make_dynamic(value);
+	if(out == nullptr) return out;
+	size_t written = 0, n = fp_view_size(value);
+	for(size_t i = 0; i < n; ++i) {
+		out[written++] = out[i];
+		if(out[i] == quote && i + 1 < n && out[i + 1] == quote) ++i;
+	}
+	fpda_resize(out, written);
+	out[written] = 0;
+	return out;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LIB_FAT_POINTER_CSV_H__
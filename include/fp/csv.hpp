@@ -0,0 +1,40 @@
+/**
+ * @file csv.hpp
+ * @brief C++ wrapper for the zero copy CSV/TSV parser
+ *
+ * @code{.cpp}
+ * fp::csv_parser csv(contents);
+ * fp::raii::dynarray<fp::string_view> fields;
+ * while(csv.next_record(fields))
+ *     total += std::stod(std::string(fields[2].to_std()));
+ * @endcode
+ */
+
+#pragma once
+
+#include "string.hpp"
+#include "csv.h"
+
+namespace fp {
+	using csv_field = fp_csv_field;
+
+	/**
+	 * @brief CSV/TSV parser yielding views into the parsed buffer (see fp_csv_parser)
+	 */
+	struct csv_parser {
+		fp_csv_parser raw;
+
+		/**
+		 * @brief Create a parser over a buffer
+		 * @param input Text to parse (must outlive the parser and the fields it yields)
+		 * @param delimiter Byte separating the fields of a record
+		 * @param quote Byte quoting fields (0 to disable quoting)
+		 */
+		csv_parser(const string_view input, char delimiter = ',', char quote = '"') noexcept : raw(fp_csv_parser_create(input, delimiter, quote)) {}
+
+		inline bool next(csv_field& field) noexcept { return fp_csv_parser_next(&raw, &field); }
+		inline bool next_record(dynarray<string_view>& fields) noexcept { return fp_csv_parser_next_record(&raw, (fp_string_view**)&fields.raw); }
+
+		inline string unescape(const string_view value) const noexcept { return string{fp_csv_field_unescape(value, raw.quote)}; }
+	};
+}
@@ -183,6 +183,8 @@ struct __FatDynamicArrayHeader* __fpda_header_null_ref() FP_NOEXCEPT
 		.capacity = 0,
 		.h = {
 			.magic = 0,
+			.alignment_log2 = 0,
+			.alignment_padding = 0,
 			.size = 0,
 		}
 	};
@@ -207,20 +209,24 @@ inline static struct __FatDynamicArrayHeader* __fpda_header(const void* da) FP_N
 }
 
 /**
- * @brief Internal allocation function for dynamic arrays
+ * @brief Internal allocation function for dynamic arrays with aligned data
  * @param _size Size in bytes to allocate
  * @param extra_header_size Extra header size to allocate, allows hash tables to use the same function!
+ * @param alignment Alignment of the data in bytes (0 for no requirement)
+ * @param allocator Allocator the memory is taken from (NULL for the thread's default allocator)
  * @return Pointer to allocated data
  * @internal
  */
-void* __fpda_malloc(size_t _size, size_t extra_header_size) FP_NOEXCEPT
+void* __fpda_malloc_aligned(size_t _size, size_t extra_header_size, size_t alignment, const struct fp_allocator* allocator) FP_NOEXCEPT
 #ifdef FP_IMPLEMENTATION
 {
 	assert(_size > 0);
 	size_t size = FPDA_HEADER_SIZE + extra_header_size + _size + 1;
-	uint8_t* p = (uint8_t*)__fp_alloc(NULL, size);
-	p += FPDA_HEADER_SIZE + extra_header_size;
+	// Only hash tables carry extra headers
+	uint16_t magic = extra_header_size ? FP_HASH_TABLE_MAGIC_NUMBER : FP_DYNARRAY_MAGIC_NUMBER;
+	uint8_t* p = (uint8_t*)__fp_alloc_counted(NULL, size, alignment, FPDA_HEADER_SIZE + extra_header_size, allocator, magic);
 	if(!p) return 0;
+	p += FPDA_HEADER_SIZE + extra_header_size;
 	auto h = __fpda_header(p);
 	h->capacity = _size;
 	h->h.magic = FP_DYNARRAY_MAGIC_NUMBER;
@@ -232,11 +238,67 @@ void* __fpda_malloc(size_t _size, size_t extra_header_size) FP_NOEXCEPT
 ;
 #endif
 
+/**
+ * @brief Internal allocation function for dynamic arrays
+ * @param _size Size in bytes to allocate
+ * @param extra_header_size Extra header size to allocate, allows hash tables to use the same function!
+ * @param allocator Allocator the memory is taken from (NULL for the thread's default allocator)
+ * @return Pointer to allocated data
+ * @internal
+ */
+inline static void* __fpda_malloc(size_t _size, size_t extra_header_size, const struct fp_allocator* allocator) FP_NOEXCEPT {
+	return __fpda_malloc_aligned(_size, extra_header_size, 0, allocator);
+}
+
+/**
+ * @brief Internal reallocation function for dynamic arrays
+ * @param da Existing dynamic array (or hash table)
+ * @param _size New capacity in bytes
+ * @param extra_header_size Extra header size that was passed to __fpda_malloc
+ * @return Pointer to the (possibly moved) data
+ *
+ * The block is resized through the allocator which created it, so the allocator
+ * gets a chance to extend the block in place instead of copying it.
+ * @internal
+ */
+void* __fpda_realloc(void* da, size_t _size, size_t extra_header_size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	assert(_size > 0);
+	size_t size = FPDA_HEADER_SIZE + extra_header_size + _size + 1;
+	uint8_t* p = ((uint8_t*)da) - FPDA_HEADER_SIZE - extra_header_size;
+	p = (uint8_t*)__fp_alloc_counted(p, size, 0, 0, NULL, __fpda_header(da)->h.magic);
+	if(!p) return 0;
+	p += FPDA_HEADER_SIZE + extra_header_size;
+	auto h = __fpda_header(p);
+	h->capacity = _size;
+	h->h.data[_size] = 0;
+	return p;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Internal function allocating an empty dynamic array with a given capacity
+ * @param type_size Size of each element
+ * @param capacity Initial capacity in elements
+ * @param alignment Alignment of the data in bytes (0 for no requirement)
+ * @param allocator Allocator the memory is taken from (NULL for the thread's default allocator)
+ * @return Pointer to allocated data
+ * @internal
+ */
+inline static void* __fpda_malloc_with_capacity(size_t type_size, size_t capacity, size_t alignment, const struct fp_allocator* allocator) FP_NOEXCEPT {
+	void* out = __fpda_malloc_aligned(type_size * (capacity > 0 ? capacity : 1), 0, alignment, allocator);
+	if(out) __fpda_header(out)->capacity = capacity;
+	return out;
+}
+
 /**
  * @brief Allocate a dynamic array with initial capacity
  * @param type Element type
  * @param _size Initial capacity in elements
- * @return Dynamic array with specified capacity and size
+ * @return Dynamic array with specified capacity and a size of zero
  *
  * @code
  * // Allocate with capacity for 100 integers
@@ -247,13 +309,55 @@ void* __fpda_malloc(size_t _size, size_t extra_header_size) FP_NOEXCEPT
  * fpda_free_and_null(arr);
  * @endcode
  */
-#define fpda_malloc(type, _size) ((type*)((uint8_t*)(*__fpda_header(__fpda_malloc(NULL, sizeof(type) * (_size), 0)) = (struct __FatDynamicArrayHeader){\
-	.capacity = 0,\
-	.h = {\
-		.magic = FP_DYNARRAY_MAGIC_NUMBER,\
-		.size = (_size),\
-	}\
-}).h.data))
+#define fpda_malloc(type, _size) fpda_malloc_with_allocator(type, _size, NULL)
+
+/**
+ * @brief Allocate a dynamic array with initial capacity through a specific allocator
+ * @param type Element type
+ * @param _size Initial capacity in elements
+ * @param allocator Allocator the memory is taken from (NULL for the thread's default allocator)
+ * @return Dynamic array with specified capacity and a size of zero
+ *
+ * The allocator is remembered by the array, all future growth and the final fpda_free
+ * go through the same allocator.
+ *
+ * @code
+ * fp_dynarray(int) arr = fpda_malloc_with_allocator(int, 16, &my_allocator);
+ * for(int i = 0; i < 100; i++)
+ *     fpda_push_back(arr, i); // Grows through my_allocator
+ * fpda_free_and_null(arr);   // Freed through my_allocator
+ * @endcode
+ */
+#define fpda_malloc_with_allocator(type, _size, allocator) ((type*)__fpda_malloc_with_capacity(sizeof(type), (_size), 0, (allocator)))
+
+/**
+ * @brief Allocate a dynamic array whose data is aligned to a specific boundary
+ * @param type Element type
+ * @param _size Initial capacity in elements
+ * @param alignment Alignment of the data in bytes (a power of two, at most FP_MAX_ALIGNMENT)
+ * @return Dynamic array with specified capacity and a size of zero
+ *
+ * The alignment is remembered by the array, the data stays aligned as the array grows, shrinks or is cloned.
+ *
+ * @code
+ * fp_dynarray(float) samples = fpda_malloc_aligned(float, 256, 64); // Cache line aligned
+ * for(int i = 0; i < 10000; i++)
+ *     fpda_push_back(samples, i); // Still 64 byte aligned
+ * assert(((uintptr_t)samples) % 64 == 0);
+ * fpda_free_and_null(samples);
+ * @endcode
+ */
+#define fpda_malloc_aligned(type, _size, alignment) ((type*)__fpda_malloc_with_capacity(sizeof(type), (_size), (alignment), NULL))
+
+/**
+ * @brief Allocate a dynamic array whose data is aligned to a specific boundary through a specific allocator
+ * @param type Element type
+ * @param _size Initial capacity in elements
+ * @param alignment Alignment of the data in bytes (a power of two, at most FP_MAX_ALIGNMENT)
+ * @param allocator Allocator the memory is taken from (NULL for the thread's default allocator)
+ * @return Dynamic array with specified capacity and a size of zero
+ */
+#define fpda_malloc_aligned_with_allocator(type, _size, alignment, allocator) ((type*)__fpda_malloc_with_capacity(sizeof(type), (_size), (alignment), (allocator)))
 
 #ifdef __GNUC__
 __attribute__((no_sanitize_address))
@@ -277,6 +381,39 @@ inline static bool is_fpda(const void* da) FP_NOEXCEPT {
 	return __fpda_header(da)->h.magic == FP_DYNARRAY_MAGIC_NUMBER;
 }
 
+/**
+ * @brief Get the allocator a dynamic array was created with
+ * @param da Dynamic array
+ * @return The allocator (NULL if da isn't a dynamic array or uses FP_ALLOCATION_FUNCTION)
+ *
+ * @code
+ * fp_dynarray(int) arr = fpda_malloc_with_allocator(int, 10, &my_allocator);
+ * assert(fpda_get_allocator(arr) == &my_allocator);
+ * fpda_free_and_null(arr);
+ * @endcode
+ */
+inline static const struct fp_allocator* fpda_get_allocator(const void* da) FP_NOEXCEPT {
+	if(!is_fpda(da)) return NULL;
+	return __fp_allocation_header(__fpda_header(da))->allocator;
+}
+
+/**
+ * @brief Get the alignment a dynamic array was created with
+ * @param da Dynamic array
+ * @return The requested alignment in bytes (0 if da isn't a dynamic array or no alignment was requested)
+ *
+ * @code
+ * fp_dynarray(double) arr = fpda_malloc_aligned(double, 10, 32);
+ * assert(fpda_get_alignment(arr) == 32);
+ * fpda_free_and_null(arr);
+ * @endcode
+ */
+inline static size_t fpda_get_alignment(const void* da) FP_NOEXCEPT {
+	if(!is_fpda(da)) return 0;
+	uint8_t log2 = __fp_allocation_header(__fpda_header(da))->h.alignment_log2;
+	return log2 ? ((size_t)1) << log2 : 0;
+}
+
 /**
  * @brief Free a dynamic array
  * @param da Dynamic array to free
@@ -293,7 +430,7 @@ void fpda_free(void* da) FP_NOEXCEPT
 {
 	auto h = __fpda_header(da);
 	if(h != __fpda_header_null_ref())
-		__fp_alloc(h, 0);
+		__fp_alloc_counted(h, 0, 0, 0, NULL, h->h.magic);
 }
 #else
 ;
@@ -411,9 +548,9 @@ inline static size_t fpda_capacity(const void* da) FP_NOEXCEPT {
 }
 
 #define __FP_MAYBE_GROW_IMPL(da, type_size, new_size, update_utilized, exact_sizing,\
-							malloc_fn, free_fn, header_fn, is_valid_fn,\
+							malloc_fn, realloc_fn, header_fn, is_valid_fn,\
 							GET_CAPACITY, SET_CAPACITY, GET_SIZE, SET_SIZE,\
-							GET_DATA, COPY_EXTRA)\
+							GET_DATA)\
 do {\
 	if(*(da) == NULL) {\
 		size_t initial_size = (exact_sizing) ? (new_size) : FPDA_DEFAULT_SIZE_BYTES / (type_size);\
@@ -435,18 +572,18 @@ do {\
 		return GET_DATA(_h) + ((type_size) * ((new_size) - 1));\
 	}\
 \
+	/* Resize through the allocator that owns the block, the headers move along with the data */\
+	FP_ZONE_SCOPED_NAMED("fp grow");\
 	size_t _size2 = (exact_sizing) ? (new_size) : fp_upper_power_of_two(new_size);\
-	void* _new = malloc_fn((type_size) * _size2);\
+	void* _new = realloc_fn(*(da), (type_size) * _size2);\
+	if(!_new) return NULL;\
+	__fp_stats_record_growth(__fpda_header(_new)->h.magic, (type_size) * _size2);\
 	auto _newH = header_fn(_new);\
 	if(update_utilized) {\
-		size_t _cur = GET_SIZE(_h);\
+		size_t _cur = GET_SIZE(_newH);\
 		SET_SIZE(_newH, _cur > (new_size) ? _cur : (new_size));\
 	}\
 	SET_CAPACITY(_newH, _size2);\
-	COPY_EXTRA(_newH, _h);\
-	memcpy(GET_DATA(_newH), GET_DATA(_h), (type_size) * GET_SIZE(_h));\
-\
-	free_fn(*(da));\
 	*(da) = _new;\
 	return GET_DATA(_newH) + ((type_size) * ((new_size) - 1));\
 } while(0)
@@ -457,15 +594,16 @@ do {\
 #define __FPDA_GET_SIZE(H) ((H)->h.size)
 #define __FPDA_SET_SIZE(H, v) ((H)->h.size = (v))
 #define __FPDA_GET_DATA(H) ((H)->h.data)
-#define __FPDA_COPY_EXTRA(newH, oldH) ((void)0)
 
 inline static void* __fpda_maybe_grow(void** da, size_t type_size, size_t new_size, bool update_utilized, bool exact_sizing) FP_NOEXCEPT {
-#define __fpda_malloc_impl(size) __fpda_malloc(size, 0)
+#define __fpda_malloc_impl(size) __fpda_malloc(size, 0, NULL)
+#define __fpda_realloc_impl(da, size) __fpda_realloc(da, size, 0)
 	__FP_MAYBE_GROW_IMPL(da, type_size, new_size, update_utilized, exact_sizing,
-						__fpda_malloc_impl, fpda_free, __fpda_header, is_fpda,
+						__fpda_malloc_impl, __fpda_realloc_impl, __fpda_header, is_fpda,
 						__FPDA_GET_CAPACITY, __FPDA_SET_CAPACITY,
 						__FPDA_GET_SIZE, __FPDA_SET_SIZE,
-						__FPDA_GET_DATA, __FPDA_COPY_EXTRA);
+						__FPDA_GET_DATA);
+#undef __fpda_realloc_impl
 #undef __fpda_malloc_impl
 }
 
@@ -785,17 +923,18 @@ inline static void* __fpda_delete(void** da, size_t type_size, size_t start, siz
 	size_t length = (raw + fpda_size(raw) * type_size) - oldStart;
 
 	if(make_size_match_capacity) {
-		fp_dynarray(uint8_t) new_ = NULL;
+		// Close the gap first, then shrink the block in place through its allocator
 		size_t newLength = fpda_size(raw) - count;
-		fpda_grow_to_size(new_, newLength * type_size);
+		if(count > 0) memmove(newStart, oldStart, length);
+
+		size_t bytes = FP_MAX(newLength * type_size, 1);
+		uint8_t* new_ = (uint8_t*)(raw ? __fpda_realloc(raw, bytes, 0) : __fpda_malloc(bytes, 0, NULL));
+		if(!new_) return NULL;
 		__fpda_header(new_)->h.size = newLength;
 		__fpda_header(new_)->capacity = newLength;
+		new_[newLength * type_size] = 0;
 
 		newStart = new_ + start * type_size;
-		if(oldStart != raw) memcpy(new_, raw, newStart - new_);
-		memcpy(newStart, oldStart, length);
-
-		fpda_free(*da);
 		*da = new_;
 
 	} else if(count > 0) {
@@ -1214,6 +1353,7 @@ inline static void __fpda_clone_to(void** dest, const void* src, size_t type_siz
 inline static void* __fpda_clone(const void* src, size_t type_size) FP_NOEXCEPT {
 	void* out = NULL;
 	if(src == NULL) return out;
+	if(fpda_get_alignment(src)) out = __fpda_malloc_with_capacity(1, fpda_size(src) * type_size, fpda_get_alignment(src), NULL); // Clones stay aligned
 	__fpda_clone_to(&out, src, type_size, true);
 	return out;
 }
@@ -115,6 +115,17 @@ namespace fp {
 		 */
 		inline size_t capacity() const { return fpda_capacity(ptr()); }
 
+		/**
+		 * @brief Get the allocator this array allocates through
+		 * @return The allocator (nullptr when FP_ALLOCATION_FUNCTION is used)
+		 *
+		 * @code
+		 * fp::raii::dynarray<int> arr = fp::dynarray<int>::with_allocator(&my_allocator);
+		 * assert(arr.allocator() == &my_allocator);
+		 * @endcode
+		 */
+		inline const fp_allocator* allocator() const { return fpda_get_allocator(ptr()); }
+
 		/**
 		 * @brief Free the dynamic array
 		 * @param nullify If true, sets pointer to null (default: true)
@@ -169,7 +180,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline Derived& reserve(size_t size) {
-			fpda_reserve(ptr(), size);
+			fpda_reserve(growable_ptr(), size);
 			return *derived();
 		}
 
@@ -192,7 +203,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline Derived& grow(size_t to_add, const T& value = {}) {
-			fpda_grow_and_initialize(ptr(), to_add, value);
+			fpda_grow_and_initialize(growable_ptr(), to_add, value);
 			return *derived();
 		}
 
@@ -217,7 +228,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline Derived& grow_uninitialized(size_t to_add) {
-			fpda_grow(ptr(), to_add);
+			fpda_grow(growable_ptr(), to_add);
 			return *derived();
 		}
 
@@ -239,7 +250,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline Derived& grow_to_size(size_t size, const T& value = {}) {
-			fpda_grow_to_size_and_initialize(ptr(), size, value);
+			fpda_grow_to_size_and_initialize(growable_ptr(), size, value);
 			return *derived();
 		}
 
@@ -249,7 +260,7 @@ namespace fp {
 		 * @return Reference to this array for chaining
 		 */
 		inline Derived& grow_to_size_uninitialized(size_t size) {
-			fpda_grow_to_size(ptr(), size);
+			fpda_grow_to_size(growable_ptr(), size);
 			return *derived();
 		}
 
@@ -270,7 +281,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline T& push_back(const T& value) {
-			return fpda_push_back(ptr(), value);
+			return fpda_push_back(growable_ptr(), value);
 		}
 
 		/**
@@ -298,7 +309,7 @@ namespace fp {
 		 */
 		template<typename... Targs>
 		inline T& emplace_back(Targs... args) {
-			auto out = fpda_grow(ptr(), 1);
+			auto out = fpda_grow(growable_ptr(), 1);
 			return *(new(out) T(std::forward<Targs>(args)...));
 		}
 
@@ -377,7 +388,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline T& insert(size_t pos, const T& value = {}) {
-			return fpda_insert(ptr(), pos, value);
+			return fpda_insert(growable_ptr(), pos, value);
 		}
 
 		/**
@@ -406,7 +417,7 @@ namespace fp {
 		 */
 		template<typename... Targs>
 		inline T& emplace(size_t pos, Targs... args) {
-			auto out = fpda_insert_uninitialized(ptr(), pos, 1);
+			auto out = fpda_insert_uninitialized(growable_ptr(), pos, 1);
 			return *(new(out) T(std::forward<Targs>(args)...));
 		}
 
@@ -428,7 +439,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline T& push_front(const T& value = {}) {
-			return fpda_push_front(ptr(), value);
+			return fpda_push_front(growable_ptr(), value);
 		}
 
 		/**
@@ -474,7 +485,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline view<T> insert_uninitialized(size_t pos, size_t count = 1) {
-			fpda_insert_uninitialized(ptr(), pos, count);
+			fpda_insert_uninitialized(growable_ptr(), pos, count);
 			return derived()->view(pos, count);
 		}
 
@@ -607,7 +618,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline Derived& resize(size_t size) {
-			fpda_resize(ptr(), size);
+			fpda_resize(growable_ptr(), size);
 			return *derived();
 		}
 
@@ -812,7 +823,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline Derived& concatenate_view_in_place(const view<const T> view) {
-			fpda_concatenate_view_in_place(ptr(), view);
+			fpda_concatenate_view_in_place(growable_ptr(), view);
 			return *derived();
 		}
 
@@ -853,7 +864,7 @@ namespace fp {
 		 * @endcode
 		 */
 		inline Derived& concatenate_in_place(const Derived& other) {
-			fpda_concatenate_in_place(ptr(), other.ptr());
+			fpda_concatenate_in_place(growable_ptr(), other.ptr());
 			return *derived();
 		}
 
@@ -891,11 +902,19 @@ namespace fp {
 
 		/// @brief Get reference to internal pointer (const version)
 		inline const T* const & ptr() const { return derived()->ptr(); }
+
+		/// @brief Get reference to internal pointer for an operation which may allocate (arrays with an alignment requirement allocate their aligned storage here)
+		inline T*& growable_ptr() {
+			if constexpr(Derived::alignment > 0)
+				if(ptr() == nullptr) ptr() = fpda_malloc_aligned(T, 1, Derived::alignment);
+			return ptr();
+		}
 	};
 
 	/**
 	 * @brief Dynamic array with manual memory management
 	 * @tparam T Element type
+	 * @tparam Align Alignment in bytes of the array's data (0 for whatever the allocator provides)
 	 *
 	 * fp::dynarray is a std::vector-like container built on fat pointers. Provides automatic growth,
 	 * efficient insertion/deletion, and full iterator support. Requires manual free()
@@ -1006,13 +1025,26 @@ namespace fp {
 	 *
 	 * arr.free();
 	 * @endcode
+	 *
+	 * @section example_aligned Aligned Storage
+	 * @code
+	 * fp::dynarray<float, 32> samples; // Data is always 32 byte aligned, even as it grows
+	 * for(int i = 0; i < 1000; i++)
+	 *     samples.push_back(i);
+	 *
+	 * __m256 first = _mm256_load_ps(samples.data());
+	 * samples.free();
+	 * @endcode
 	 */
-	template<typename T>
-	struct dynarray: public pointer<T>, public dynarray_crtp<T, dynarray<T>> {
+	template<typename T, size_t Align = 0>
+	struct dynarray: public pointer<T>, public dynarray_crtp<T, dynarray<T, Align>> {
 		using super = pointer<T>;
 		using super::super;
 		using super::ptr;
 
+		/// @brief Alignment in bytes of the array's data (0 for whatever the allocator provides)
+		static constexpr size_t alignment = Align;
+
 		/**
 		 * @brief Construct from initializer list
 		 * @param init Initializer list of values
@@ -1039,7 +1071,25 @@ namespace fp {
 
 		FP_HPP_DEFAULT_CONSTRUCTOR_BLOCK(dynarray, super);
 
-		using crtp = dynarray_crtp<T, dynarray<T>>;
+		/**
+		 * @brief Create an empty array which allocates through a specific allocator
+		 * @param allocator Allocator the memory is taken from (nullptr for the thread's default allocator)
+		 * @param capacity Initial capacity in elements
+		 * @return Empty array, all future growth goes through allocator
+		 *
+		 * @code
+		 * fp::raii::dynarray<int> arr = fp::dynarray<int>::with_allocator(&my_allocator, 16);
+		 * for(int i = 0; i < 100; i++)
+		 *     arr.push_back(i); // Grows through my_allocator
+		 * @endcode
+		 */
+		static dynarray with_allocator(const fp_allocator* allocator, size_t capacity = 1) {
+			dynarray out;
+			out.ptr() = fpda_malloc_aligned_with_allocator(T, capacity, Align, allocator);
+			return out;
+		}
+
+		using crtp = dynarray_crtp<T, dynarray<T, Align>>;
 		using crtp::free;
 		using crtp::clone;
 
@@ -1059,7 +1109,7 @@ namespace fp {
 		 * numbers.free();
 		 * @endcode
 		 */
-		inline operator dynarray<std::add_const_t<T>>() const { return *(dynarray<std::add_const_t<T>>*)this; }
+		inline operator dynarray<std::add_const_t<T>, Align>() const { return *(dynarray<std::add_const_t<T>, Align>*)this; }
 
 		fp::auto_free<dynarray> auto_free() { return std::move(*this); }
 	};
@@ -1189,7 +1239,7 @@ namespace fp {
 		 * @see fp::dynarray for manual memory management version
 		 * @see fp::raii::pointer for RAII fat pointers
 		 */
-		template<typename T>
-		using dynarray = auto_free<fp::dynarray<T>>;
+		template<typename T, size_t Align = 0>
+		using dynarray = auto_free<fp::dynarray<T, Align>>;
 	}
 }
@@ -38,22 +38,50 @@ typedef void*(*fpht_copy_function_t)(void*, const void*, size_t) FP_NOEXCEPT;
 #endif
 typedef void(*fpht_finalize_function_t)(fp_void_view) FP_NOEXCEPT;
 
-// #ifndef FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR
-// #define FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR .95
-// #endif
+// Tables double as soon as inserting would fill more than this fraction of their cells
+#ifndef FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR
+#define FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR .8f
+#endif
 
+// Entries are displaced to stay within this many cells of their bucket (at most 63, or 31 with a 32 bit size_t),
+// larger neighborhoods let tables fill up more before growing: ~40% full with 8 cells, ~82% with 32, ~90% with 48
 #ifndef FP_DEFAULT_HASH_TABLE_NEIGHBORHOOD_SIZE
-#define FP_DEFAULT_HASH_TABLE_NEIGHBORHOOD_SIZE 8
+	#if SIZE_MAX > 0xFFFFFFFF
+		#define FP_DEFAULT_HASH_TABLE_NEIGHBORHOOD_SIZE 32
+	#else
+		#define FP_DEFAULT_HASH_TABLE_NEIGHBORHOOD_SIZE 16
+	#endif
+#endif
+
+// Tables remember the hash of every entry (8 bytes per cell), so growing never calls the hash function again and
+// lookups only compare keys whose hashes match. Worth it when hashing or comparing keys is expensive (long strings, ...)
+#ifndef FP_DEFAULT_HASH_TABLE_STORE_HASHES
+#define FP_DEFAULT_HASH_TABLE_STORE_HASHES false
 #endif
 
 #ifndef FP_DEFAULT_HASH_TABLE_BASE_SIZE
-#define FP_DEFAULT_HASH_TABLE_BASE_SIZE FP_DEFAULT_HASH_TABLE_NEIGHBORHOOD_SIZE
+#define FP_DEFAULT_HASH_TABLE_BASE_SIZE 8
 #endif
 
 #ifndef FP_DEFAULT_HASH_TABLE_MAX_FAIL_RETRIES
-#define FP_DEFAULT_HASH_TABLE_MAX_FAIL_RETRIES FP_DEFAULT_HASH_TABLE_NEIGHBORHOOD_SIZE
+#define FP_DEFAULT_HASH_TABLE_MAX_FAIL_RETRIES 8
 #endif
 
+// How a table stores the metadata of its cells and probes for keys
+enum fp_hash_table_engine {
+	// A size_t per cell: occupied flag in the top bit (__FPHT_ENTRY_OCCUPIED) and a bitmap of which of the following neighborhood_size cells hold keys hashing to it
+	FP_HASH_TABLE_ENGINE_HOPSCOTCH,
+	// A control byte per cell (7 bits of the hash, empty or deleted), matched FP_HASH_TABLE_GROUP_SIZE cells at a time
+	// so most probes compare a single key. neighborhood_size is then the number of groups probed before growing
+	FP_HASH_TABLE_ENGINE_SWISS,
+};
+
+#ifndef FP_DEFAULT_HASH_TABLE_ENGINE
+#define FP_DEFAULT_HASH_TABLE_ENGINE FP_HASH_TABLE_ENGINE_HOPSCOTCH
+#endif
+
+#define FP_HASH_TABLE_GROUP_SIZE 16
+
 struct fp_hash_table_config {
 	fp_hash_function_t hash_function
 #ifdef __cplusplus
@@ -95,11 +123,26 @@ struct fp_hash_table_config {
 		= FP_DEFAULT_HASH_TABLE_MAX_FAIL_RETRIES
 #endif
 	;
-// 	float max_load_factor
-// #ifdef __cplusplus
-// 		= FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR
-// #endif
-// 	;
+	const struct fp_allocator* allocator // NULL = the thread's default allocator
+#ifdef __cplusplus
+		= nullptr
+#endif
+	;
+	enum fp_hash_table_engine engine
+#ifdef __cplusplus
+		= FP_DEFAULT_HASH_TABLE_ENGINE
+#endif
+	;
+	float max_load_factor // 1 = only grow once an insert fails to find room
+#ifdef __cplusplus
+		= FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR
+#endif
+	;
+	bool store_hashes
+#ifdef __cplusplus
+		= FP_DEFAULT_HASH_TABLE_STORE_HASHES
+#endif
+	;
 };
 
 inline static struct fp_hash_table_config fpht_default_config() {
@@ -115,13 +158,22 @@ inline static struct fp_hash_table_config fpht_default_config() {
 		FP_DEFAULT_HASH_TABLE_BASE_SIZE,
 		FP_DEFAULT_HASH_TABLE_NEIGHBORHOOD_SIZE,
 		FP_DEFAULT_HASH_TABLE_MAX_FAIL_RETRIES,
-		// FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR,
+		NULL,
+		FP_DEFAULT_HASH_TABLE_ENGINE,
+		FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR,
+		FP_DEFAULT_HASH_TABLE_STORE_HASHES,
 	};
 #endif
 }
 
 struct __FatHashTableHeader {
-	size_t* entry_infos;
+	union {
+		size_t* entry_infos; // FP_HASH_TABLE_ENGINE_HOPSCOTCH
+		uint8_t* control; // FP_HASH_TABLE_ENGINE_SWISS
+	};
+	uint64_t* hashes; // Full hash of the entry in each cell (NULL unless config.store_hashes)
+	size_t count; // Occupied cells
+	size_t deleted; // Tombstones (swiss tables only), they lengthen probes just like entries do
 	const struct fp_hash_table_config config;
 	struct __FatDynamicArrayHeader h;
 };
@@ -149,30 +201,117 @@ inline static const struct fp_hash_table_config* __fp_hash_table_config(const vo
 	return &__fpht_header(table)->config;
 }
 
+inline static const struct fp_allocator* fpht_get_allocator(const void* table) FP_NOEXCEPT {
+	if(!is_fpht(table)) return NULL;
+	return __fp_allocation_header(__fpht_header(table))->allocator;
+}
+
+inline static bool __fpht_is_swiss(const void* table) FP_NOEXCEPT {
+	return __fp_hash_table_config(table)->engine == FP_HASH_TABLE_ENGINE_SWISS;
+}
+
+// The top bit of an entry info marks its cell as occupied, the low bits are the hop bitmap of the bucket
+#define __FPHT_ENTRY_OCCUPIED ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
 inline static size_t* __fpht_entry_info(const void* table, size_t index) FP_NOEXCEPT {
 	assert(index < fpda_size(__fpht_header(table)->entry_infos));
 	return __fpht_header(table)->entry_infos + index;
 }
 
+// Control bytes of full cells hold the low 7 bits of their hash, free ones have their top bit set
+#define __FPHT_CONTROL_EMPTY ((uint8_t)0x80)
+#define __FPHT_CONTROL_DELETED ((uint8_t)0xFE)
+
+// Bitmask of the cells of a group whose control byte is control
+inline static uint32_t __fpht_group_match(const uint8_t* group, uint8_t control) FP_NOEXCEPT {
+#ifdef FP_SIMD_X86
+	__m128i bytes = _mm_loadu_si128((const __m128i*)group);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)control)));
+#else
+	uint32_t mask = 0;
+	for(size_t i = 0; i < FP_HASH_TABLE_GROUP_SIZE; ++i)
+		mask |= (uint32_t)(group[i] == control) << i;
+	return mask;
+#endif
+}
+
+// Bitmask of the empty or deleted cells of a group
+inline static uint32_t __fpht_group_match_free(const uint8_t* group) FP_NOEXCEPT {
+#ifdef FP_SIMD_X86
+	return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+	uint32_t mask = 0;
+	for(size_t i = 0; i < FP_HASH_TABLE_GROUP_SIZE; ++i)
+		mask |= (uint32_t)(group[i] >> 7) << i;
+	return mask;
+#endif
+}
+
 inline static bool __fpht_entry_occupied(const void* table, size_t index) FP_NOEXCEPT {
-	return *__fpht_entry_info(table, index) & (1 << 31);
+	if(__fpht_is_swiss(table)) {
+		assert(index < fpda_size(__fpht_header(table)->control));
+		return (__fpht_header(table)->control[index] & 0x80) == 0;
+	}
+	return *__fpht_entry_info(table, index) & __FPHT_ENTRY_OCCUPIED;
 }
 
 inline static void __fpht_entry_set_occupied(const void* table, size_t index, bool state) FP_NOEXCEPT {
 	assert(index < fpda_size(table));
-	if(state) *__fpht_entry_info(table, index) |= (1 << 31);
-	else *__fpht_entry_info(table, index) &= ~(1 << 31);
+	if(__fpht_is_swiss(table)) {
+		assert(!state); // Full cells are marked by __fpht_insert, which knows their hash
+		// Probes stop at groups with an empty cell, so a cell only needs a tombstone if its group has none
+		uint8_t* control = __fpht_header(table)->control;
+		if(control[index] & 0x80) return;
+		const uint8_t* group = control + index / FP_HASH_TABLE_GROUP_SIZE * FP_HASH_TABLE_GROUP_SIZE;
+		control[index] = __fpht_group_match(group, __FPHT_CONTROL_EMPTY) ? __FPHT_CONTROL_EMPTY : __FPHT_CONTROL_DELETED;
+		__fpht_header(table)->deleted += control[index] == __FPHT_CONTROL_DELETED;
+		--__fpht_header(table)->count;
+		return;
+	}
+	if(state) *__fpht_entry_info(table, index) |= __FPHT_ENTRY_OCCUPIED;
+	else if(*__fpht_entry_info(table, index) & __FPHT_ENTRY_OCCUPIED) {
+		*__fpht_entry_info(table, index) &= ~__FPHT_ENTRY_OCCUPIED;
+		--__fpht_header(table)->count;
+		// Forget the entry in the neighborhood of the bucket it belongs to, which is the only one pointing at it
+		size_t mask = fpda_size(table) - 1, neighborhood = __fp_hash_table_config(table)->neighborhood_size;
+		for(size_t back = 0; back < neighborhood; ++back)
+			if(*__fpht_entry_info(table, (index - back) & mask) & ((size_t)1 << back)) {
+				*__fpht_entry_info(table, (index - back) & mask) &= ~((size_t)1 << back);
+				break;
+			}
+	}
 }
 
-inline static size_t __fpht_hash(const void* table, const fp_void_view key) {
+// Tables always have a power of two size, so wrapping around them is a mask rather than a division
+inline static size_t __fpht_mask(const void* table) FP_NOEXCEPT {
+	assert((fpda_size(table) & (fpda_size(table) - 1)) == 0);
+	return fpda_size(table) - 1;
+}
+
+// Fibonacci hashing: multiplying by 2^64/phi and folding the high half down makes the masked low bits
+// depend on every bit of the hash, so weak hashes (identities, pointers, ...) still spread over the table
+inline static uint64_t __fpht_mix_hash(uint64_t hash) FP_NOEXCEPT {
+#ifndef FP_HASH_TABLE_DISABLE_HASH_MIXING
+	hash *= 0x9E3779B97F4A7C15ull;
+	return hash ^ (hash >> 32);
+#else
+	return hash;
+#endif
+}
+
+inline static uint64_t __fpht_hash_full(const void* table, const fp_void_view key) {
 #ifndef FP_HASH_TABLE_STATIC_HASH_FUNCTION
 	auto config = __fp_hash_table_config(table);
-	return config->hash_function(key) % fpda_size(table);
+	return __fpht_mix_hash(config->hash_function(key));
 #else
-	return FP_DEFAULT_HASH_FUNCTION(key) % fpda_size(table);
+	return __fpht_mix_hash(FP_DEFAULT_HASH_FUNCTION(key));
 #endif
 }
 
+inline static size_t __fpht_hash(const void* table, const fp_void_view key) {
+	return __fpht_hash_full(table, key) & __fpht_mask(table);
+}
+
 inline static bool __fpht_compare_equal(const void* table, const fp_void_view a, const fp_void_view b) {
 #ifndef FP_HASH_TABLE_STATIC_COMPARE_EQUAL_FUNCTION
 	auto config = __fp_hash_table_config(table);
@@ -218,37 +357,49 @@ inline static void __fpht_finalize(const void* table, fp_void_view what) {
 #define __FPHT_GET_SIZE(H) ((H)->h.h.size)
 #define __FPHT_SET_SIZE(H, v) ((H)->h.h.size = (v))
 #define __FPHT_GET_DATA(H) ((H)->h.h.data)
-#define __FPHT_COPY_EXTRA(newH, oldH) do {                                 \
-	(newH)->entry_infos = (oldH)->entry_infos;                             \
-	memcpy((void*)&(newH)->config, &(oldH)->config, sizeof(struct fp_hash_table_config)); \
-} while(0)
 
 inline static void* __fpht_maybe_grow(void** da, size_t type_size, size_t new_size, bool update_utilized, bool exact_sizing) FP_NOEXCEPT {
 	void* tmp;
-#define __fpht_malloc_impl(size) (tmp = __fpda_malloc(size, FP_HASH_TABLE_HEADER_SIZE - FPDA_HEADER_SIZE), __fpda_header(tmp)->h.magic = FP_HASH_TABLE_MAGIC_NUMBER, tmp)
-#define __fpht_free_impl(da) __fp_alloc(__fpht_header(da), 0)
+#define __fpht_malloc_impl(size) (tmp = __fpda_malloc(size, FP_HASH_TABLE_HEADER_SIZE - FPDA_HEADER_SIZE, NULL), __fpda_header(tmp)->h.magic = FP_HASH_TABLE_MAGIC_NUMBER, tmp)
+#define __fpht_realloc_impl(da, size) __fpda_realloc(da, size, FP_HASH_TABLE_HEADER_SIZE - FPDA_HEADER_SIZE)
 	__FP_MAYBE_GROW_IMPL(da, type_size, new_size, update_utilized, exact_sizing,
-						__fpht_malloc_impl, __fpht_free_impl, __fpht_header, is_fpht,
+						__fpht_malloc_impl, __fpht_realloc_impl, __fpht_header, is_fpht,
 						__FPHT_GET_CAPACITY, __FPHT_SET_CAPACITY,
 						__FPHT_GET_SIZE, __FPHT_SET_SIZE,
-						__FPHT_GET_DATA, __FPHT_COPY_EXTRA);
-#undef __fpht_free_impl
+						__FPHT_GET_DATA);
+#undef __fpht_realloc_impl
 #undef __fpht_malloc_impl
 }
 
-void* __fp_create_hash_table(size_t type_size, const struct fp_hash_table_config config)
+void* __fp_create_hash_table(size_t type_size, struct fp_hash_table_config config)
 #ifdef FP_IMPLEMENTATION
 {
-	void* out = __fpda_malloc(type_size * config.base_size, FP_HASH_TABLE_HEADER_SIZE - FPDA_HEADER_SIZE);
+	config.base_size = config.base_size > 1 ? fp_upper_power_of_two(config.base_size) : 1;
+	assert(config.engine == FP_HASH_TABLE_ENGINE_SWISS || config.neighborhood_size < sizeof(size_t) * 8); // Hop bitmaps share the entry info with the occupied bit
+	if(config.engine == FP_HASH_TABLE_ENGINE_SWISS && config.base_size < FP_HASH_TABLE_GROUP_SIZE)
+		config.base_size = FP_HASH_TABLE_GROUP_SIZE; // Swiss tables hold at least one whole group
+	void* out = __fpda_malloc(type_size * config.base_size, FP_HASH_TABLE_HEADER_SIZE - FPDA_HEADER_SIZE, config.allocator);
 	__fpda_header(out)->h.magic = FP_HASH_TABLE_MAGIC_NUMBER;
 
 	auto h = __fpht_header(out);
 	h->h.capacity = config.base_size;
 	h->h.h.size = config.base_size;
+	h->count = 0;
+	h->deleted = 0;
 	memcpy((void*)&h->config, &config, sizeof(struct fp_hash_table_config));
 
-	h->entry_infos = nullptr;
-	fpda_grow_to_size_and_initialize(h->entry_infos, config.base_size, 0);
+	if(config.engine == FP_HASH_TABLE_ENGINE_SWISS) {
+		h->control = fpda_malloc_with_allocator(uint8_t, config.base_size, config.allocator);
+		fpda_grow_to_size_and_initialize(h->control, config.base_size, __FPHT_CONTROL_EMPTY);
+	} else {
+		h->entry_infos = fpda_malloc_with_allocator(size_t, config.base_size, config.allocator);
+		fpda_grow_to_size_and_initialize(h->entry_infos, config.base_size, 0);
+	}
+	h->hashes = NULL;
+	if(config.store_hashes) {
+		h->hashes = fpda_malloc_with_allocator(uint64_t, config.base_size, config.allocator);
+		fpda_grow_to_size(h->hashes, config.base_size);
+	}
 
 	return out;
 }
@@ -260,30 +411,176 @@ void* __fp_create_hash_table(size_t type_size, const struct fp_hash_table_config
 #define fp_create_default_hash_table(type) fp_create_hash_table(type, fpht_default_config())
 
 inline static size_t __fpht_double_size_and_rehash(void** table, size_t type_size, size_t failures);
+inline static size_t __fpht_swiss_rehash(void** table, size_t type_size, size_t new_size);
 
-inline static size_t __fpht_find_empty_hash_position(const void* table, size_t hash) {
-	auto config = __fp_hash_table_config(table);
-	for(size_t i = 0; i < config->neighborhood_size; ++i) {
-		size_t probe = (hash + i) % fpda_size(table);
-		if(!__fpht_entry_occupied(table, probe))
-			return probe;
+inline static size_t __fpht_hash_distance(const void* table, size_t hash, size_t position) {
+	return (position - hash) & __fpht_mask(table);
+}
+
+// Bitmap of the cells in the neighborhood of a bucket which hold keys hashing to it
+inline static size_t __fpht_hop_info(const void* table, size_t bucket) FP_NOEXCEPT {
+	return *__fpht_entry_info(table, bucket) & (((size_t)1 << __fp_hash_table_config(table)->neighborhood_size) - 1);
+}
+
+// Finds a free cell within the neighborhood of a bucket. The closest free cell is found by probing linearly, if it is
+// too far away entries between the two are moved into it (staying within their own neighborhoods) until the free
+// cell is close enough. Fails only if no entry can be moved, the table then needs to grow
+inline static size_t __fpht_hopscotch_make_room(void* table, size_t type_size, size_t bucket) {
+	size_t mask = __fpht_mask(table), neighborhood = __fp_hash_table_config(table)->neighborhood_size;
+	size_t distance = 0;
+	while(__fpht_entry_occupied(table, (bucket + distance) & mask))
+		if(++distance > mask) return fp_not_found; // Full
+
+	auto tableP = (uint8_t*)table;
+	size_t free = (bucket + distance) & mask;
+	while(distance >= neighborhood) {
+		size_t back = neighborhood - 1;
+		for( ; back > 0; --back) { // The furthest back bucket with an entry before the free cell moves it the furthest
+			size_t owner = (free - back) & mask;
+			size_t hops = __fpht_hop_info(table, owner) & (((size_t)1 << back) - 1);
+			if(!hops) continue;
+
+			size_t offset = __fp_lowest_bit64(hops), from = (owner + offset) & mask;
+			__fpht_copy(table, tableP + free * type_size, tableP + from * type_size, type_size);
+			if(__fpht_header(table)->hashes) __fpht_header(table)->hashes[free] = __fpht_header(table)->hashes[from];
+			*__fpht_entry_info(table, owner) ^= ((size_t)1 << offset) | ((size_t)1 << back);
+			__fpht_entry_set_occupied(table, free, true);
+			*__fpht_entry_info(table, from) &= ~__FPHT_ENTRY_OCCUPIED;
+			free = from;
+			distance -= back - offset;
+			break;
+		}
+		if(back == 0) return fp_not_found;
+	}
+	return free;
+}
+
+// Swiss tables probe whole groups: starting at the group picked by the hash, then 1, 2, 3, ... groups further
+// (triangular numbers, which visit every group of a power of two sized table)
+inline static size_t __fpht_swiss_find_free(const void* table, uint64_t hash, size_t max_probes) {
+	const uint8_t* control = __fpht_header(table)->control;
+	size_t groups_mask = __fpht_mask(table) / FP_HASH_TABLE_GROUP_SIZE;
+	size_t group = (hash >> 7) & groups_mask;
+	for(size_t probe = 0; probe < max_probes && probe <= groups_mask; group = (group + ++probe) & groups_mask) {
+		uint32_t free = __fpht_group_match_free(control + group * FP_HASH_TABLE_GROUP_SIZE);
+		if(free) return group * FP_HASH_TABLE_GROUP_SIZE + __fp_lowest_bit(free);
 	}
 	return fp_not_found;
 }
 
-inline static size_t __fpht_hash_distance(const void* table, size_t hash, size_t position) {
-	size_t size = fpda_size(table);
-	if(position < hash)
-		return size - hash + position;
-	else return position - hash;
+inline static size_t __fpht_swiss_find_position(const void* table, const fp_void_view key) FP_NOEXCEPT {
+	uint64_t hash = __fpht_hash_full(table, key);
+	const uint8_t* control = __fpht_header(table)->control;
+	const uint64_t* hashes = __fpht_header(table)->hashes;
+	auto tableP = (uint8_t*)table;
+	size_t type_size = fp_view_size(key), groups_mask = __fpht_mask(table) / FP_HASH_TABLE_GROUP_SIZE;
+	size_t group = (hash >> 7) & groups_mask;
+	for(size_t probe = 0; probe <= groups_mask; group = (group + ++probe) & groups_mask) {
+		const uint8_t* cells = control + group * FP_HASH_TABLE_GROUP_SIZE;
+		for(uint32_t matches = __fpht_group_match(cells, hash & 0x7F); matches; matches &= matches - 1) {
+			size_t position = group * FP_HASH_TABLE_GROUP_SIZE + __fp_lowest_bit(matches);
+			if(hashes && hashes[position] != hash) continue;
+			if(__fpht_compare_equal(table, key, fp_void_view_literal(tableP + position * type_size, type_size)))
+				return position;
+		}
+		if(__fpht_group_match(cells, __FPHT_CONTROL_EMPTY)) return fp_not_found; // The key would have been inserted here
+	}
+	return fp_not_found;
+}
+
+// Whether inserting another entry would push the table (counting its tombstones) over its max load factor
+inline static bool __fpht_should_grow(const void* table) FP_NOEXCEPT {
+	auto h = __fpht_header(table);
+	return (float)(h->count + h->deleted + 1) > __fp_hash_table_config(table)->max_load_factor * fpda_size(table);
+}
+
+// Makes room for another entry in a table which should grow. If at least a quarter of the load are tombstones
+// rehashing at the same size (which drops them) is enough, otherwise the table doubles
+inline static size_t __fpht_swiss_make_room(void** table, size_t type_size, size_t failures) {
+	auto h = __fpht_header(*table);
+	if(4 * h->deleted < h->count + h->deleted) return __fpht_double_size_and_rehash(table, type_size, failures);
+	__fp_stats_record_rehash();
+	return __fpht_swiss_rehash(table, type_size, fpda_size(*table));
+}
+
+inline static void* __fpht_swiss_insert(void** table, const fp_void_view key, size_t failures) {
+	if(__fpht_should_grow(*table) && __fpht_swiss_make_room(table, fp_view_size(key), failures) != fp_not_found)
+		return NULL;
+	auto config = __fp_hash_table_config(*table); // Only read once the table stopped moving
+	uint64_t hash = __fpht_hash_full(*table, key);
+	size_t position = __fpht_swiss_find_free(*table, hash, config->neighborhood_size);
+	if(position == fp_not_found && failures < config->max_fail_retries) {
+		if(__fpht_double_size_and_rehash(table, fp_view_size(key), failures + 1) != fp_not_found)
+			return NULL;
+		return __fpht_swiss_insert(table, key, failures + 1);
+	} else if(position == fp_not_found)
+		return NULL;
+
+	auto tableP = (uint8_t*)*table;
+	__fpht_copy(*table, tableP + fp_view_size(key) * position, fp_view_data_void(key), fp_view_size(key));
+	__fpht_header(*table)->deleted -= __fpht_header(*table)->control[position] == __FPHT_CONTROL_DELETED;
+	__fpht_header(*table)->control[position] = hash & 0x7F;
+	if(__fpht_header(*table)->hashes) __fpht_header(*table)->hashes[position] = hash;
+	++__fpht_header(*table)->count;
+	return tableP + fp_view_size(key) * position;
+}
+
+// Moves every entry of a swiss table into a table of new_size cells
+inline static size_t __fpht_swiss_rehash(void** table, size_t type_size, size_t new_size) {
+	FP_ZONE_SCOPED;
+	size_t size = fpda_size(__fpht_header(*table)->control);
+	auto allocator = fpht_get_allocator(*table);
+	// Entries are relocated bitwise (as growing the table through realloc does anyway)
+	fp_dynarray(uint8_t) cells = fpda_malloc_with_allocator(uint8_t, size * type_size, allocator);
+	fp_dynarray(uint8_t) control = fpda_malloc_with_allocator(uint8_t, size, allocator);
+	memcpy(cells, *table, size * type_size);
+	memcpy(control, __fpht_header(*table)->control, size);
+	// Stored hashes move along with their entries, otherwise every entry is hashed again
+	fp_dynarray(uint64_t) hashes = NULL;
+	if(__fpht_header(*table)->hashes) {
+		hashes = fpda_malloc_with_allocator(uint64_t, size, allocator);
+		memcpy(hashes, __fpht_header(*table)->hashes, size * sizeof(uint64_t));
+	}
+
+	__fpht_maybe_grow(table, type_size, new_size, true, true);
+	fpda_clear(__fpht_header(*table)->control);
+	fpda_grow_to_size_and_initialize(__fpht_header(*table)->control, new_size, __FPHT_CONTROL_EMPTY);
+	if(hashes) {
+		fpda_clear(__fpht_header(*table)->hashes);
+		fpda_grow_to_size(__fpht_header(*table)->hashes, new_size);
+	}
+
+	size_t failed = fp_not_found;
+	auto tableP = (uint8_t*)*table;
+	__fpht_header(*table)->count = 0;
+	__fpht_header(*table)->deleted = 0;
+	for(size_t i = 0; i < size; ++i) {
+		if(control[i] & 0x80) continue;
+		uint64_t hash = hashes ? hashes[i] : __fpht_hash_full(*table, fp_void_view_literal(cells + i * type_size, type_size));
+		size_t position = __fpht_swiss_find_free(*table, hash, SIZE_MAX);
+		if(position == fp_not_found) { failed = i; break; } // Only if entries were added to the table by hand
+		memcpy(tableP + position * type_size, cells + i * type_size, type_size);
+		__fpht_header(*table)->control[position] = hash & 0x7F;
+		if(hashes) __fpht_header(*table)->hashes[position] = hash;
+		++__fpht_header(*table)->count;
+	}
+	fpda_free(cells);
+	fpda_free(control);
+	if(hashes) fpda_free(hashes);
+	return failed;
 }
 
 inline static void* __fpht_insert(void** table, const fp_void_view key, size_t failures) {
-	auto config = __fp_hash_table_config(*table);
-	size_t hash = __fpht_hash(*table, key);
-	size_t position = __fpht_find_empty_hash_position(*table, hash);
+	if(__fpht_is_swiss(*table)) return __fpht_swiss_insert(table, key, failures);
+
+	if(__fpht_should_grow(*table) && __fpht_double_size_and_rehash(table, fp_view_size(key), failures) != fp_not_found)
+		return NULL;
+	auto config = __fp_hash_table_config(*table); // Only read once the table stopped moving
+	uint64_t full_hash = __fpht_hash_full(*table, key);
+	size_t hash = full_hash & __fpht_mask(*table);
+	size_t position = __fpht_hopscotch_make_room(*table, fp_view_size(key), hash);
 	if(position == fp_not_found && failures < config->max_fail_retries) {
-		if(!__fpht_double_size_and_rehash(table, fp_view_size(key), failures + 1))
+		if(__fpht_double_size_and_rehash(table, fp_view_size(key), failures + 1) != fp_not_found)
 			return NULL;
 		return __fpht_insert(table, key, failures + 1);
 	} else if(position == fp_not_found)
@@ -292,8 +589,10 @@ inline static void* __fpht_insert(void** table, const fp_void_view key, size_t f
 	auto tableP = (uint8_t*)*table;
 	__fpht_copy(*table, tableP + fp_view_size(key) * position, fp_view_data_void(key), fp_view_size(key));
 	// Mark position as belonging to hash and as being occupied
-	*__fpht_entry_info(*table, hash) |= (1 << __fpht_hash_distance(table, hash, position));
+	*__fpht_entry_info(*table, hash) |= ((size_t)1 << __fpht_hash_distance(*table, hash, position));
 	__fpht_entry_set_occupied(*table, position, true);
+	if(__fpht_header(*table)->hashes) __fpht_header(*table)->hashes[position] = full_hash;
+	++__fpht_header(*table)->count;
 
 	return tableP + fp_view_size(key) * position;
 }
@@ -301,62 +600,104 @@ inline static void* __fpht_insert(void** table, const fp_void_view key, size_t f
 #define __fpht_validate_table_and_key(table, key) assert(sizeof(*table) == sizeof(key))
 #define fpht_insert_assume_unique(table, key) (__fpht_validate_table_and_key(table, key), (FP_TYPE_OF_REMOVE_POINTER(table)*)__fpht_insert((void**)&table, fp_void_view_literal(&(key), sizeof(key)), 0))
 
-inline static size_t __fpht_rehash(void** table, size_t type_size, size_t failures) {
-	size_t size = fpda_size(*table);
-	{ // Confirm that if we have manually added or removed entries that there are enough entry infos to store their metadata
-		size_t entries_size = fpda_size(__fpht_header(*table)->entry_infos);
-		if(entries_size < size)
-			fpda_grow_and_initialize(__fpht_header(*table)->entry_infos, size - entries_size, 0);
-	}
-	uint8_t* scratch = fp_alloca(uint8_t, type_size);
+// Moves every entry of a hopscotch table into a table of (at least) new_size cells, doubling it again whenever an
+// entry can't be placed (at most max_fail_retries times)
+inline static size_t __fpht_hopscotch_rehash(void** table, size_t type_size, size_t new_size, size_t failures) {
+	FP_ZONE_SCOPED;
+	size_t max_fail_retries = __fp_hash_table_config(*table)->max_fail_retries;
+	// Tables whose entries were added or removed by hand might not have an entry info for every cell
+	size_t size = fpda_size(*table), infos = fpda_size(__fpht_header(*table)->entry_infos);
+	if(infos < size) size = infos;
+
+	size_t count = 0;
+	for(size_t i = 0; i < size; ++i)
+		count += __fpht_entry_occupied(*table, i);
+	fp_dynarray(uint8_t) entries = fpda_malloc_with_allocator(uint8_t, count * type_size + 1, fpht_get_allocator(*table));
+	// Stored hashes move along with their entries, otherwise every entry is hashed again (on every retry)
+	const uint64_t* stored = __fpht_header(*table)->hashes;
+	fp_dynarray(uint64_t) hashes = stored ? fpda_malloc_with_allocator(uint64_t, count + 1, fpht_get_allocator(*table)) : NULL;
 	auto tableP = (uint8_t*)*table;
+	for(size_t i = 0, j = 0; i < size; ++i)
+		if(__fpht_entry_occupied(*table, i)) {
+			if(hashes) hashes[j] = stored[i];
+			__fpht_copy(*table, entries + type_size * j++, tableP + i * type_size, type_size);
+		}
 
-	for(size_t i = 0; i < size; ++i) {
-		bool occupied = __fpht_entry_occupied(*table, i);
-		*__fpht_entry_info(*table, i) = 0; // Clear hash metadata and mark unoccupied
-		if(!occupied) continue;
+	size_t failed = fp_not_found;
+	for(;;) {
+		__fpht_maybe_grow(table, type_size, new_size, true, true);
+		__FPHT_SET_SIZE(__fpht_header(*table), new_size);
+		fpda_clear(__fpht_header(*table)->entry_infos);
+		fpda_grow_to_size_and_initialize(__fpht_header(*table)->entry_infos, new_size, 0);
+		if(hashes) {
+			fpda_clear(__fpht_header(*table)->hashes);
+			fpda_grow_to_size(__fpht_header(*table)->hashes, new_size);
+		}
 
-		__fpht_copy(*table, scratch, tableP + i * type_size, type_size);
-		if(!__fpht_insert(table, fp_void_view_literal(scratch, type_size), failures))
-			return i;
-		tableP = (uint8_t*)*table;  // re-read in case of realloc
+		failed = fp_not_found;
+		tableP = (uint8_t*)*table;
+		__fpht_header(*table)->count = 0;
+		for(size_t i = 0; i < count; ++i) {
+			uint64_t full_hash = hashes ? hashes[i] : __fpht_hash_full(*table, fp_void_view_literal(entries + i * type_size, type_size));
+			size_t hash = full_hash & __fpht_mask(*table);
+			size_t position = __fpht_hopscotch_make_room(*table, type_size, hash);
+			if(position == fp_not_found) { failed = i; break; }
+
+			__fpht_copy(*table, tableP + position * type_size, entries + i * type_size, type_size);
+			*__fpht_entry_info(*table, hash) |= (size_t)1 << __fpht_hash_distance(*table, hash, position);
+			__fpht_entry_set_occupied(*table, position, true);
+			if(hashes) __fpht_header(*table)->hashes[position] = full_hash;
+			++__fpht_header(*table)->count;
+		}
+		if(failed == fp_not_found || failures++ >= max_fail_retries) break;
+		new_size *= 2;
+		__fp_stats_record_rehash();
 	}
-	return fp_not_found;
+	fpda_free(entries);
+	if(hashes) fpda_free(hashes);
+	return failed;
+}
+
+inline static size_t __fpht_rehash(void** table, size_t type_size, size_t failures) {
+	if(__fpht_is_swiss(*table)) return __fpht_swiss_rehash(table, type_size, fp_upper_power_of_two(fpda_size(*table)));
+	return __fpht_hopscotch_rehash(table, type_size, fp_upper_power_of_two(fpda_size(*table)), failures);
 }
 
 #define fpht_rehash(table) __fpht_rehash((void**)&table, sizeof(*table), 0)
 
 inline static size_t __fpht_double_size_and_rehash(void** table, size_t type_size, size_t failures) {
-	size_t size = fpda_size(*table), new_size = size * 2;
-	// TODO: Will this function work... since the header allocation sizes are off?
-	__fpht_maybe_grow(table, type_size, new_size, true, true);
-	fpda_grow_and_initialize(__fpht_header(*table)->entry_infos, size, 0);
+	FP_ZONE_SCOPED;
+	size_t new_size = fpda_size(*table) * 2;
+	__fp_stats_record_rehash();
+	if(__fpht_is_swiss(*table)) return __fpht_swiss_rehash(table, type_size, new_size);
+	return __fpht_hopscotch_rehash(table, type_size, new_size, failures);
+}
 
-	auto tableP = (uint8_t*)*table;
-	for(size_t i = 0; i < size; ++i)
-		if(i % 2 == 1) {
-			// Copy every other cell to the blank half of the table and null their original memory
-			__fpht_copy(*table, tableP + (new_size - i) * type_size, tableP + i * type_size, type_size);
-			memset(tableP + i * type_size, 0, type_size);
-			// Swap the entry info of the cells
-			fpda_swap(__fpht_header(*table)->entry_infos, i, new_size - i);
-		}
+#define fpht_double_size_and_rehash(table) __fpht_double_size_and_rehash((void**)&table, sizeof(*table), 0)
 
-	return __fpht_rehash(table, type_size, failures);
+// Grows the table (once) so count entries fit without exceeding its max load factor
+inline static size_t __fpht_reserve(void** table, size_t type_size, size_t count) {
+	size_t needed = fp_upper_power_of_two((size_t)((float)count / __fp_hash_table_config(*table)->max_load_factor) + 1);
+	if(needed <= fpda_size(*table)) return fp_not_found;
+
+	__fp_stats_record_rehash();
+	if(__fpht_is_swiss(*table)) return __fpht_swiss_rehash(table, type_size, needed);
+	return __fpht_hopscotch_rehash(table, type_size, needed, 0);
 }
 
-#define fpht_double_size_and_rehash(table) __fpht_double_size_and_rehash((void**)&table, sizeof(*table), 0)
+#define fpht_reserve(table, count) __fpht_reserve((void**)&table, sizeof(*table), (count))
 
 inline static size_t __fpht_find_position(const void* table, const fp_void_view key) FP_NOEXCEPT {
-	auto config = __fp_hash_table_config(table);
-	auto hash = __fpht_hash(table, key);
-	auto hash_info = *__fpht_entry_info(table, hash);
+	if(__fpht_is_swiss(table)) return __fpht_swiss_find_position(table, key);
+
+	uint64_t full_hash = __fpht_hash_full(table, key);
+	const uint64_t* hashes = __fpht_header(table)->hashes;
 	auto tableP = (uint8_t*)table;
-	size_t type_size = fp_view_size(key);
-	for(size_t i = 0; i < config->neighborhood_size; ++i) {
-		if((hash_info & (1 << i)) == 0) continue;
-		size_t probe = (hash + i) % fpda_size(table);
+	size_t type_size = fp_view_size(key), mask = __fpht_mask(table), hash = full_hash & mask;
+	for(size_t hops = __fpht_hop_info(table, hash); hops; hops &= hops - 1) {
+		size_t probe = (hash + __fp_lowest_bit64(hops)) & mask;
 		if(!__fpht_entry_occupied(table, probe)) continue;
+		if(hashes && hashes[probe] != full_hash) continue;
 		if(__fpht_compare_equal(table, key, fp_void_view_literal(tableP + probe * type_size, type_size)))
 			return probe;
 	}
@@ -383,7 +724,7 @@ inline static size_t fpht_find_first_occupied_position(const void* table) {
 #define fpht_find_first_occupied(table) (__fpda_global_concatenate_pointer = (void*)fpht_find_first_occupied_position(table), (size_t)__fpda_global_concatenate_pointer != fp_not_found ? table + (size_t)__fpda_global_concatenate_pointer : NULL)
 
 inline static size_t fpht_find_last_occupied_position(const void* table) {
-	for(size_t i = fpda_size(table); --i; )
+	for(size_t i = fpda_size(table); i--; )
 		if(__fpht_entry_occupied(table, i))
 			return i;
 	return fp_not_found;
@@ -392,18 +733,14 @@ inline static size_t fpht_find_last_occupied_position(const void* table) {
 
 inline static size_t fpht_occupied_size(const void* table) {
 	if(!table) return 0;
-
-	size_t count = 0;
-	for(size_t i = fpda_size(table); --i; )
-		if(__fpht_entry_occupied(table, i))
-			++count;
-	return count;
+	return __fpht_header(table)->count;
 }
 
 void* __fp_create_hash_table_from_view(size_t type_size, fp_void_view view, const struct fp_hash_table_config config)
 #ifdef FP_IMPLEMENTATION
 {
 	auto out = __fp_create_hash_table(type_size, config);
+	__fpht_reserve(&out, type_size, fp_view_size(view));
 	auto p = (uint8_t*)fp_view_data_void(view);
 	for(size_t i = 0; i < fp_view_size(view); ++i)
 		__fpht_insert(&out, fp_void_view_literal(p + i * type_size, type_size), 0);
@@ -426,12 +763,23 @@ inline static void __fpht_finalize_all(void** table, size_t type_size) {
 }
 
 #define fpht_finalize(table) __fpht_finalize_all((void**)&table, sizeof(*table))
-#define fpht_clear(table) (fpht_finalize(table), fpda_clear(table))
+
+// Empties the table, keeping its size
+inline static void __fpht_clear(void** table, size_t type_size) {
+	__fpht_finalize_all(table, type_size);
+	auto h = __fpht_header(*table);
+	if(__fpht_is_swiss(*table)) memset(h->control, __FPHT_CONTROL_EMPTY, fpda_size(h->control));
+	else memset(h->entry_infos, 0, fpda_size(h->entry_infos) * sizeof(size_t));
+	h->count = 0;
+	h->deleted = 0;
+}
+#define fpht_clear(table) __fpht_clear((void**)&table, sizeof(*table))
 
 inline static void __fpht_free(void** table, size_t type_size) {
 	__fpht_finalize_all(table, type_size);
 	fpda_free_and_null(__fpht_header(*table)->entry_infos);
-	__fp_alloc(__fpht_header(*table), 0);
+	if(__fpht_header(*table)->hashes) fpda_free_and_null(__fpht_header(*table)->hashes);
+	__fp_alloc_counted(__fpht_header(*table), 0, 0, 0, NULL, FP_HASH_TABLE_MAGIC_NUMBER);
 }
 #define fpht_free(table) __fpht_free((void**)&table, sizeof(*table))
 #define fpht_free_and_null(table) (fpht_free(table), table = NULL)
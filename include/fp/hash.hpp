@@ -59,6 +59,10 @@ namespace fp {
 			size_t base_size = FP_DEFAULT_HASH_TABLE_BASE_SIZE;
 			size_t neighborhood_size = FP_DEFAULT_HASH_TABLE_NEIGHBORHOOD_SIZE;
 			size_t max_fail_retries = FP_DEFAULT_HASH_TABLE_MAX_FAIL_RETRIES;
+			const fp_allocator* allocator = nullptr;
+			fp_hash_table_engine engine = FP_DEFAULT_HASH_TABLE_ENGINE;
+			float max_load_factor = FP_DEFAULT_HASH_TABLE_MAX_LOAD_FACTOR;
+			bool store_hashes = FP_DEFAULT_HASH_TABLE_STORE_HASHES;
 		};
 		struct config_input: public config {
 			using config::config;
@@ -100,6 +104,10 @@ namespace fp {
 			return fpht_double_size_and_rehash(ptr());
 		}
 
+		size_t reserve(size_t count) {
+			return fpht_reserve(ptr(), count);
+		}
+
 		T& insert(const T& key, bool assume_unique = false) {
 			if(assume_unique) return *fpht_insert_assume_unique(ptr(), key);
 			else return *fpht_insert(ptr(), key);
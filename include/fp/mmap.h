@@ -0,0 +1,336 @@
+/**
+ * @file mmap.h
+ * @brief Memory mapping backends for huge fat pointers and dynamic arrays, and fat pointers over files
+ *
+ * Growing a dynamic array to hundreds of megabytes through malloc means every doubling briefly needs
+ * the old block, the new block and a copy in between. The mmap allocator instead backs large blocks
+ * with anonymous mappings which grow with mremap, the kernel simply moves page table entries around
+ * so nothing is copied and the peak stays at the live size. Blocks smaller than FP_MMAP_THRESHOLD
+ * keep using FP_ALLOCATION_FUNCTION.
+ *
+ * @note glibc only declares mremap with _GNU_SOURCE (always defined by g++ and clang++), define it before including
+ * any system header when compiling C. Without it growing a mapping falls back to mapping a new block and copying.
+ *
+ * @section example_mmap Huge Array Usage
+ * @code
+ * fp_dynarray(float) samples = fpda_malloc_with_allocator(float, 1024, fp_mmap_allocator(true)); // With transparent huge pages
+ * for(size_t i = 0; i < 100 * 1024 * 1024; i++)
+ *     fpda_push_back(samples, i); // Once past the threshold growth is a mremap, not a copy
+ * fpda_free_and_null(samples);
+ * @endcode
+ *
+ * Files can also be mapped straight into a (read only) fat pointer, no copy into the heap is ever made and
+ * pages are only read from disk as they are touched.
+ *
+ * @section example_mmap_file File Usage
+ * @code
+ * fp_string dictionary = fp_mmap_file(char, "tokens.txt");
+ * if(!dictionary) return;
+ * size_t offset = fp_string_view_find(fp_string_to_view(dictionary), fp_string_view_from_literal("needle"), 0);
+ * fp_munmap_file_and_null(dictionary);
+ * @endcode
+ *
+ * @note On platforms without mmap every block comes from FP_ALLOCATION_FUNCTION, and mapped files are read into the heap.
+ */
+
+#ifndef __LIB_FAT_POINTER_MMAP_H__
+#define __LIB_FAT_POINTER_MMAP_H__
+
+#include "pointer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define FP_MMAP_SUPPORTED
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#else
+	#include <stdio.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FP_MMAP_THRESHOLD
+/// @brief Blocks at least this many bytes large are backed by their own memory mapping
+#define FP_MMAP_THRESHOLD (1024 * 1024)
+#endif
+
+/// @cond INTERNAL
+inline static size_t __fp_mmap_round_to_pages(size_t size) FP_NOEXCEPT {
+#ifdef FP_MMAP_SUPPORTED
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	return (size + page - 1) & ~(page - 1);
+#else
+	return size;
+#endif
+}
+/// @endcond
+
+/**
+ * @brief Map a fresh anonymous block
+ * @internal
+ */
+void* __fp_mmap_map(size_t size, bool huge_pages) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+#ifdef FP_MMAP_SUPPORTED
+	void* p = mmap(NULL, __fp_mmap_round_to_pages(size), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(p == MAP_FAILED) return NULL;
+	#ifdef MADV_HUGEPAGE
+	if(huge_pages) madvise(p, __fp_mmap_round_to_pages(size), MADV_HUGEPAGE);
+	#endif
+	return p;
+#else
+	return FP_ALLOCATION_FUNCTION(NULL, size);
+#endif
+}
+#else
+;
+#endif
+
+/**
+ * @brief Mmap fp_allocator::allocate implementation
+ * @internal
+ */
+void* __fp_mmap_allocate(void* state, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(size < FP_MMAP_THRESHOLD) return FP_ALLOCATION_FUNCTION(NULL, size);
+	return __fp_mmap_map(size, *(const bool*)state);
+}
+#else
+;
+#endif
+
+/**
+ * @brief Mmap fp_allocator::deallocate implementation
+ * @internal
+ */
+void __fp_mmap_deallocate(void* state, void* p, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	(void)state;
+#ifdef FP_MMAP_SUPPORTED
+	if(size >= FP_MMAP_THRESHOLD) {
+		munmap(p, __fp_mmap_round_to_pages(size));
+		return;
+	}
+#endif
+	FP_ALLOCATION_FUNCTION(p, 0);
+}
+#else
+;
+#endif
+
+/**
+ * @brief Mmap fp_allocator::reallocate implementation (remaps instead of copying once both sizes are past the threshold)
+ * @internal
+ */
+void* __fp_mmap_reallocate(void* state, void* p, size_t old_size, size_t new_size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(old_size < FP_MMAP_THRESHOLD && new_size < FP_MMAP_THRESHOLD)
+		return FP_ALLOCATION_FUNCTION(p, new_size);
+#ifdef FP_MMAP_SUPPORTED
+	if(old_size >= FP_MMAP_THRESHOLD && new_size >= FP_MMAP_THRESHOLD) {
+		size_t old_mapped = __fp_mmap_round_to_pages(old_size), new_mapped = __fp_mmap_round_to_pages(new_size);
+		if(old_mapped == new_mapped) return p;
+	#ifdef MREMAP_MAYMOVE
+		void* out = mremap(p, old_mapped, new_mapped, MREMAP_MAYMOVE);
+		if(out == MAP_FAILED) return NULL;
+		#ifdef MADV_HUGEPAGE
+		if(*(const bool*)state) madvise(out, new_mapped, MADV_HUGEPAGE);
+		#endif
+		return out;
+	#else
+		if(new_mapped < old_mapped) { // Give the tail back in place
+			munmap(((uint8_t*)p) + new_mapped, old_mapped - new_mapped);
+			return p;
+		}
+	#endif
+	}
+#endif
+
+	// Crossing the threshold (or no mremap)... move the data between the heap and a mapping
+	void* out = __fp_mmap_allocate(state, new_size);
+	if(!out) return NULL;
+	memcpy(out, p, old_size < new_size ? old_size : new_size);
+	__fp_mmap_deallocate(state, p, old_size);
+	return out;
+}
+#else
+;
+#endif
+
+/** \addtogroup capi
+ *  @{
+ */
+
+/**
+ * @brief Get an allocator which backs blocks of at least FP_MMAP_THRESHOLD bytes with their own anonymous memory mapping
+ * @param huge_pages Whether the mappings should be backed by transparent huge pages (where supported)
+ * @return Allocator which can be passed to fp_malloc_with_allocator, fpda_malloc_with_allocator, hash table configs, etc...
+ *
+ * Growing a mapped block (with mremap on Linux) never copies the data, so arrays can grow to many gigabytes
+ * without ever needing twice their size in memory.
+ *
+ * @code
+ * fp_dynarray(uint64_t) ids = fpda_malloc_with_allocator(uint64_t, 1, fp_mmap_allocator(false));
+ * for(uint64_t i = 0; i < 500000000; i++)
+ *     fpda_push_back(ids, i);
+ * fpda_free_and_null(ids); // Unmapped
+ * @endcode
+ */
+const struct fp_allocator* fp_mmap_allocator(bool huge_pages) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static const bool regular_pages = false, transparent_huge_pages = true;
+	static const struct fp_allocator regular = {__fp_mmap_allocate, __fp_mmap_reallocate, __fp_mmap_deallocate, (void*)&regular_pages};
+	static const struct fp_allocator huge = {__fp_mmap_allocate, __fp_mmap_reallocate, __fp_mmap_deallocate, (void*)&transparent_huge_pages};
+	return huge_pages ? &huge : &regular;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Internal header structure stored before the header of a mapped file
+ *
+ * Layout (the headers live at the end of a page of their own, the file is mapped on the page after):
+ * [...][__FatPointerMappedHeader][__FatPointerHeader][file data...][zero padding]
+ *                                                    ^ returned pointer (page aligned)
+ * @internal
+ */
+struct __FatPointerMappedHeader {
+	size_t mapping_size;          ///< Size in bytes of the whole mapping (including the header page)
+	struct __FatPointerHeader h;  ///< Base fat pointer header
+};
+
+/// @brief Size of the mapped header in bytes
+#define FP_MAPPED_HEADER_SIZE offsetof(struct __FatPointerMappedHeader, h)
+
+/**
+ * @brief Check if a fat pointer is a memory mapped file
+ * @param p Pointer to check
+ * @return true if p was created by fp_mmap_file
+ */
+FP_CONSTEXPR inline static bool fp_is_mapped(const void* p) FP_NOEXCEPT {
+	return fp_magic_number(p) == FP_MAPPED_MAGIC_NUMBER;
+}
+
+/**
+ * @brief Internal function mapping a file into a fat pointer
+ * @param path Path to the file
+ * @param type_size Size of each element (the length is the file size divided by this)
+ * @return Pointer to the file's data (NULL if the file could not be opened or mapped)
+ * @internal
+ */
+void* __fp_mmap_file(const char* path, size_t type_size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+#ifdef FP_MMAP_SUPPORTED
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) return NULL;
+	struct stat info;
+	if(fstat(fd, &info) != 0) {
+		close(fd);
+		return NULL;
+	}
+
+	// Reserve a header page, the file, and at least one zero byte after it (so the data is null terminated)
+	size_t length = (size_t)info.st_size, page = __fp_mmap_round_to_pages(1);
+	size_t mapping_size = page + __fp_mmap_round_to_pages(length + 1);
+	uint8_t* region = (uint8_t*)mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(region == MAP_FAILED) {
+		close(fd);
+		return NULL;
+	}
+	if(length > 0 && mmap(region + page, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(region, mapping_size);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+
+	uint8_t* p = region + page;
+	struct __FatPointerMappedHeader* m = (struct __FatPointerMappedHeader*)(p - FP_HEADER_SIZE - FP_MAPPED_HEADER_SIZE);
+	m->mapping_size = mapping_size;
+	m->h.magic = FP_MAPPED_MAGIC_NUMBER;
+	m->h.size = length / type_size;
+	mprotect(region, page, PROT_READ);
+	return p;
+#else
+	FILE* file = fopen(path, "rb");
+	if(!file) return NULL;
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	uint8_t* p = (uint8_t*)__fp_alloc(NULL, length > 0 ? length : 1);
+	if(p && length > 0 && fread(p, 1, length, file) != (size_t)length) {
+		fp_free(p);
+		p = NULL;
+	}
+	fclose(file);
+	if(p) __fp_header(p)->size = length / type_size;
+	return p;
+#endif
+}
+#else
+;
+#endif
+
+/**
+ * @brief Map a file into a read only fat pointer
+ * @param type Element type
+ * @param path Path to the file
+ * @return Typed pointer to the file's data (NULL if the file could not be opened or mapped)
+ *
+ * The pointer works with every (non-modifying) fat pointer function, its length is the size of the
+ * file in elements and the data is followed by a null terminator. Must be released with fp_munmap_file.
+ *
+ * @warning The memory is mapped read only, writing through the pointer crashes.
+ *
+ * @code
+ * uint32_t* table = fp_mmap_file(uint32_t, "reference.bin");
+ * for(size_t i = 0; i < fp_length(table); i++)
+ *     lookup(table[i]);
+ * fp_munmap_file_and_null(table);
+ * @endcode
+ */
+#define fp_mmap_file(type, path) ((type*)__fp_mmap_file((path), sizeof(type)))
+
+/**
+ * @brief Release a file mapped with fp_mmap_file
+ * @param p The mapped file (invalid after this call)
+ */
+void fp_munmap_file(void* p) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(p == NULL) return;
+#ifdef FP_MMAP_SUPPORTED
+	assert(fp_is_mapped(p));
+	struct __FatPointerMappedHeader* m = (struct __FatPointerMappedHeader*)(((uint8_t*)p) - FP_HEADER_SIZE - FP_MAPPED_HEADER_SIZE);
+	munmap(((uint8_t*)p) - __fp_mmap_round_to_pages(1), m->mapping_size);
+#else
+	fp_free(p);
+#endif
+}
+#else
+;
+#endif
+
+/**
+ * @brief Release a mapped file and set the pointer to NULL
+ * @param p The mapped file
+ */
+#define fp_munmap_file_and_null(p) (fp_munmap_file(p), p = NULL)
+
+/** @} */
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_MMAP_H__
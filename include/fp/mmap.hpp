@@ -0,0 +1,61 @@
+/**
+ * @file mmap.hpp
+ * @brief C++ wrapper for fat pointers over memory mapped files
+ *
+ * @code{.cpp}
+ * fp::mapped_view<char> dictionary("tokens.txt");
+ * if(!dictionary) return;
+ * for(char c: dictionary)
+ *     count(c);
+ * @endcode
+ */
+
+#pragma once
+
+#include "pointer.hpp"
+#include "mmap.h"
+
+namespace fp {
+	/**
+	 * @brief Owning, read only fat pointer over a memory mapped file
+	 * @tparam T Element type (the length is the file size divided by sizeof(T))
+	 *
+	 * Provides the usual fat pointer interface: size, views, iteration, spans, etc... The file is unmapped when
+	 * the wrapper is destroyed.
+	 *
+	 * @warning The memory is mapped read only, writing through the view crashes.
+	 *
+	 * @code{.cpp}
+	 * fp::mapped_view<uint32_t> table("reference.bin");
+	 * auto first_hundred = table.view(0, 100);
+	 * std::span<const uint32_t> all = table.span();
+	 * @endcode
+	 */
+	template<typename T>
+	struct mapped_view: public pointer_crtp<T, mapped_view<T>> {
+		T* raw = nullptr;
+
+		mapped_view() noexcept = default;
+
+		/**
+		 * @brief Map a file
+		 * @param path Path to the file (the view is empty if it could not be mapped)
+		 */
+		mapped_view(const char* path) noexcept : raw(fp_mmap_file(T, path)) {}
+		mapped_view(const mapped_view&) = delete;
+		mapped_view(mapped_view&& o) noexcept : raw(std::exchange(o.raw, nullptr)) {}
+		mapped_view& operator=(const mapped_view&) = delete;
+		mapped_view& operator=(mapped_view&& o) noexcept { std::swap(raw, o.raw); return *this; }
+		~mapped_view() noexcept { if(raw) fp_munmap_file(raw); }
+
+		/**
+		 * @brief Check if a file is currently mapped
+		 */
+		inline bool is_open() const noexcept { return raw != nullptr; }
+
+	protected:
+		friend pointer_crtp<T, mapped_view<T>>;
+		inline T*& ptr() { return raw; }
+		inline const T* const & ptr() const { return raw; }
+	};
+}
@@ -101,6 +101,22 @@
  */
 #define assert_with_side_effects(assertion) do_and_assert(assertion, res)
 
+#include "profile.h"
+
+#if !defined(FP_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	/// @brief Defined when searches may use SSE2 (and, with FP_SIMD_AVX2_DISPATCH, AVX2 picked at runtime)
+	#define FP_SIMD_X86
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		#define FP_SIMD_AVX2_DISPATCH
+	#else
+		#include <immintrin.h>
+		#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+			#define FP_SIMD_AVX2_DISPATCH
+		#endif
+	#endif
+#endif
+
 /// @cond INTERNAL
 #define FP_DO_EXPAND(VAL) VAL ## 1
 #define FP_EXPAND(VAL) FP_DO_EXPAND(VAL)
@@ -237,6 +253,59 @@ extern "C" {
 #define FP_ALLOCATION_FUNCTION __fp_alloc_default_impl
 #endif
 
+/**
+ * @brief Function an #fp_allocator uses to allocate a new block of memory
+ * @param state The allocator's user state
+ * @param size Size in bytes to allocate
+ * @return Pointer to the allocated memory or NULL on failure
+ */
+typedef void*(*fp_allocate_function_t)(void* state, size_t size) FP_NOEXCEPT;
+/**
+ * @brief Function an #fp_allocator uses to resize a block of memory
+ * @param state The allocator's user state
+ * @param p Block to resize
+ * @param old_size Size in bytes the block was allocated with
+ * @param new_size Size in bytes the block should have
+ * @return Pointer to the (possibly moved) block or NULL on failure
+ */
+typedef void*(*fp_reallocate_function_t)(void* state, void* p, size_t old_size, size_t new_size) FP_NOEXCEPT;
+/**
+ * @brief Function an #fp_allocator uses to free a block of memory
+ * @param state The allocator's user state
+ * @param p Block to free
+ * @param size Size in bytes the block was allocated with
+ */
+typedef void(*fp_deallocate_function_t)(void* state, void* p, size_t size) FP_NOEXCEPT;
+
+/**
+ * @brief Allocator handle which can be attached to individual allocations
+ *
+ * Every heap allocation remembers the allocator that created it, so it is reallocated and freed
+ * through that same allocator, no matter where fp_free/fpda_free ends up being called from.
+ * Passing NULL wherever an allocator is expected selects the thread's default allocator
+ * (see fp_set_thread_allocator), which is FP_ALLOCATION_FUNCTION unless changed.
+ *
+ * The allocator must outlive every allocation made through it.
+ *
+ * @code{.cpp}
+ * void* counting_allocate(void* state, size_t size) { ++*(size_t*)state; return malloc(size); }
+ * void counting_deallocate(void* state, void* p, size_t size) { --*(size_t*)state; free(p); }
+ *
+ * size_t live = 0;
+ * struct fp_allocator counting = {counting_allocate, NULL, counting_deallocate, &live};
+ * int* data = fp_malloc_with_allocator(int, 100, &counting);
+ * assert(live == 1);
+ * fp_free_and_null(data);
+ * assert(live == 0);
+ * @endcode
+ */
+struct fp_allocator {
+	fp_allocate_function_t allocate;     ///< Allocates a new block (required)
+	fp_reallocate_function_t reallocate; ///< Resizes a block (optional, allocate + copy + deallocate is used when NULL)
+	fp_deallocate_function_t deallocate; ///< Frees a block (optional, memory is never returned when NULL)
+	void* state;                         ///< User state passed to every function
+};
+
 /**
  * @brief Magic numbers used to identify fat pointer types
  *
@@ -251,11 +320,14 @@ enum FP_MagicNumbers {
 	FP_STACK_MAGIC_NUMBER = 0xFEFF,       ///< Stack-allocated fat pointer
 	FP_DYNARRAY_MAGIC_NUMBER = 0xFEFD,    ///< Dynamic array fat pointer
 	FP_HASH_TABLE_MAGIC_NUMBER = 0xFEFC,  ///< Hashtable fat pointer
+	FP_MAPPED_MAGIC_NUMBER = 0xFEFB,      ///< Memory mapped file fat pointer
 };
 
 /// @cond INTERNAL
 struct __FatPointerHeaderTruncated { // TODO: Make sure to keep this struct in sync with the following one
 	uint16_t magic;
+	uint8_t alignment_log2;
+	uint16_t alignment_padding;
 	size_t size;
 };
 /// @endcond
@@ -274,8 +346,10 @@ struct __FatPointerHeaderTruncated { // TODO: Make sure to keep this struct in s
  * @internal
  */
 struct __FatPointerHeader {
-	uint16_t magic;  ///< Magic number identifying pointer type
-	size_t size;     ///< Number of elements (not bytes) in the allocation
+	uint16_t magic;             ///< Magic number identifying pointer type
+	uint8_t alignment_log2;     ///< Log2 of the alignment requested for the data of a heap allocation (0 if none)
+	uint16_t alignment_padding; ///< Bytes between the start of a heap allocation's block and its allocation header
+	size_t size;                ///< Number of elements (not bytes) in the allocation
 #ifndef __cplusplus
 	uint8_t data[];  ///< Flexible array member for user data
 #else
@@ -291,6 +365,31 @@ struct __FatPointerHeader {
 	static constexpr size_t FP_HEADER_SIZE = sizeof(__FatPointerHeader) - detail::completed_sizeof_v<decltype(__FatPointerHeader{}.data)>;
 #endif
 
+/**
+ * @brief Internal header structure stored before the header of every heap allocation
+ *
+ * Remembers which allocator created the block and how large the block is, so that the block can be
+ * resized and freed through the same allocator. Layout:
+ * [alignment padding][__FatPointerAllocationHeader][__FatPointerHeader][user data...][null terminator]
+ *                                                                      ^ returned pointer
+ * The padding is only present for aligned allocations (see fp_malloc_aligned), the headers thus
+ * always sit at a fixed negative offset from the returned pointer.
+ * @internal
+ */
+struct __FatPointerAllocationHeader {
+	const struct fp_allocator* allocator; ///< Allocator which owns this block (NULL for FP_ALLOCATION_FUNCTION)
+	size_t allocation_size;               ///< Size in bytes of the whole block (including all headers)
+	struct __FatPointerHeader h;          ///< Base fat pointer header
+};
+
+/// @brief Size of the allocation header in bytes
+#define FP_ALLOCATION_HEADER_SIZE offsetof(struct __FatPointerAllocationHeader, h)
+
+#ifndef FP_MAX_ALIGNMENT
+/// @brief Largest alignment which can be requested from fp_malloc_aligned (and friends)
+#define FP_MAX_ALIGNMENT 4096
+#endif
+
 /// @cond INTERNAL
 #define FP_CONCAT_(x,y) x##y
 #define FP_CONCAT(x,y) FP_CONCAT_(x,y)
@@ -387,6 +486,8 @@ static thread_local struct __FatPointerHeader* __fp_global_header;
 #define fp_alloca_void(_typesize, _size) (__fp_global_header = (struct __FatPointerHeader*)alloca(FP_HEADER_SIZE + _typesize * _size + 1),\
 	*__fp_global_header = (struct __FatPointerHeader) {\
 		.magic = FP_STACK_MAGIC_NUMBER,\
+		.alignment_log2 = 0,\
+		.alignment_padding = 0,\
 		.size = (_size),\
 	}, (void*)(((uint8_t*)__fp_global_header) + FP_HEADER_SIZE))
 #elif defined(_WIN32)
@@ -413,6 +514,8 @@ static thread_local struct __FatPointerHeader* __fp_global_header;
 #define fp_alloca_void(_typesize, _size) ((void*)(((uint8_t*)&((*(__FatPointerHeader*)_alloca(FP_HEADER_SIZE + _typesize * FP_MAX(_size, 8) + 1)) = \
 	__FatPointerHeader {\
 		.magic = FP_STACK_MAGIC_NUMBER,\
+		.alignment_log2 = 0,\
+		.alignment_padding = 0,\
 		.size = (_size),\
 	})) + FP_HEADER_SIZE))
 #else
@@ -439,6 +542,8 @@ static thread_local struct __FatPointerHeader* __fp_global_header;
 #define fp_alloca_void(_typesize, _size) ((void*)(((uint8_t*)&((*(__FatPointerHeader*)alloca(FP_HEADER_SIZE + _typesize * FP_MAX(_size, 8) + 1)) = \
 	__FatPointerHeader {\
 		.magic = FP_STACK_MAGIC_NUMBER,\
+		.alignment_log2 = 0,\
+		.alignment_padding = 0,\
 		.size = (_size),\
 	})) + FP_HEADER_SIZE))
 #endif
@@ -495,29 +600,391 @@ FP_CONSTEXPR inline static struct __FatPointerHeader* __fp_header(const void* _p
 }
 
 /**
- * @brief Internal allocation function for fat pointers
+ * @brief Get the allocation header of a heap allocated fat pointer
+ * @param _p Fat pointer (as returned by __fp_alloc)
+ * @return Pointer to the allocation header structure
+ * @internal
+ */
+inline static struct __FatPointerAllocationHeader* __fp_allocation_header(const void* _p) FP_NOEXCEPT {
+	uint8_t* p = (uint8_t*)_p;
+	p -= FP_HEADER_SIZE + FP_ALLOCATION_HEADER_SIZE;
+	return (struct __FatPointerAllocationHeader*)(void*)p;
+}
+
+/**
+ * @brief Allocate a block through an allocator
+ * @param allocator Allocator to use (NULL for FP_ALLOCATION_FUNCTION)
+ * @param size Size in bytes to allocate
+ * @return Pointer to the allocated block
+ * @internal
+ */
+inline static void* __fp_allocator_allocate(const struct fp_allocator* allocator, size_t size) FP_NOEXCEPT {
+	if(allocator == NULL) return FP_ALLOCATION_FUNCTION(NULL, size);
+	return allocator->allocate(allocator->state, size);
+}
+
+/**
+ * @brief Resize a block through the allocator which created it
+ * @param allocator Allocator to use (NULL for FP_ALLOCATION_FUNCTION)
+ * @param p Block to resize
+ * @param old_size Current size of the block in bytes
+ * @param new_size Requested size of the block in bytes
+ * @return Pointer to the (possibly moved) block
+ * @internal
+ */
+inline static void* __fp_allocator_reallocate(const struct fp_allocator* allocator, void* p, size_t old_size, size_t new_size) FP_NOEXCEPT {
+	if(allocator == NULL) return FP_ALLOCATION_FUNCTION(p, new_size);
+	if(allocator->reallocate) return allocator->reallocate(allocator->state, p, old_size, new_size);
+
+	void* out = allocator->allocate(allocator->state, new_size);
+	if(!out) return NULL;
+	memcpy(out, p, old_size < new_size ? old_size : new_size);
+	if(allocator->deallocate) allocator->deallocate(allocator->state, p, old_size);
+	return out;
+}
+
+/**
+ * @brief Free a block through the allocator which created it
+ * @param allocator Allocator to use (NULL for FP_ALLOCATION_FUNCTION)
+ * @param p Block to free
+ * @param size Size of the block in bytes
+ * @internal
+ */
+inline static void __fp_allocator_deallocate(const struct fp_allocator* allocator, void* p, size_t size) FP_NOEXCEPT {
+	if(allocator == NULL) FP_ALLOCATION_FUNCTION(p, 0);
+	else if(allocator->deallocate) allocator->deallocate(allocator->state, p, size);
+}
+
+/**
+ * @brief Get a reference to the allocator used by this thread when no allocator is explicitly provided
+ * @return Pointer to the thread local allocator slot (which holds NULL for FP_ALLOCATION_FUNCTION)
+ * @internal
+ */
+const struct fp_allocator** __fp_thread_allocator_ref() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static thread_local const struct fp_allocator* allocator = NULL;
+	return &allocator;
+}
+#else
+;
+#endif
+
+/** \addtogroup capi
+ *  @{
+ */
+
+/**
+ * @brief Get the allocator new allocations on this thread use when none is explicitly provided
+ * @return The thread's default allocator (NULL for FP_ALLOCATION_FUNCTION)
+ */
+inline static const struct fp_allocator* fp_thread_allocator() FP_NOEXCEPT {
+	return *__fp_thread_allocator_ref();
+}
+
+/**
+ * @brief Change the allocator new allocations on this thread use when none is explicitly provided
+ * @param allocator The new default allocator (NULL for FP_ALLOCATION_FUNCTION)
+ * @return The previous default allocator, so that it can be restored
+ *
+ * Only the creation of new containers is affected, existing ones keep using the allocator they were created with.
+ * This makes it possible to route every allocation made by a piece of code (fp_malloc, fpda_push_back,
+ * fp_string_format, ...) to a request scoped allocator without changing that code.
+ *
+ * @code{.cpp}
+ * const struct fp_allocator* previous = fp_set_thread_allocator(&request_allocator);
+ * fp_string greeting = fp_string_format("Hello %s", name); // Allocated from request_allocator
+ * fp_set_thread_allocator(previous);
+ * @endcode
+ */
+inline static const struct fp_allocator* fp_set_thread_allocator(const struct fp_allocator* allocator) FP_NOEXCEPT {
+	const struct fp_allocator* previous = *__fp_thread_allocator_ref();
+	*__fp_thread_allocator_ref() = allocator;
+	return previous;
+}
+
+/** @} */
+
+#ifdef FP_ENABLE_ALLOCATION_STATS
+/// @brief Number of buckets in fp_allocation_stats::growth_histogram
+#define FP_ALLOCATION_STATS_HISTOGRAM_SIZE (sizeof(size_t) * 8)
+
+/**
+ * @brief Allocation counters for one kind of container (see fp_allocation_stats_total)
+ *
+ * Only available when FP_ENABLE_ALLOCATION_STATS is defined (in every translation unit) before the library is included.
+ */
+struct fp_allocation_stats {
+	size_t allocations;   ///< Number of blocks allocated
+	size_t reallocations; ///< Number of blocks resized
+	size_t frees;         ///< Number of blocks freed
+	size_t bytes_live;    ///< Bytes currently allocated (including headers)
+	size_t peak_bytes;    ///< Most bytes which were allocated at once
+	size_t growths;       ///< Number of times a dynamic array or hash table ran out of capacity and was grown
+	size_t rehashes;      ///< Number of times a hash table was doubled and rehashed
+	size_t growth_histogram[FP_ALLOCATION_STATS_HISTOGRAM_SIZE]; ///< growth_histogram[i] counts growths to a capacity of [2^i, 2^(i+1)) bytes
+};
+
+/**
+ * @brief Per thread block of allocation counters, one entry for each tracked magic number
+ *
+ * Blocks are linked into a global list when a thread first allocates and are never freed,
+ * so the counts of threads which have exited still show up in the totals.
+ * @internal
+ */
+struct __FatPointerThreadStats {
+	struct __FatPointerThreadStats* next; ///< Block of the thread registered before this one
+	struct fp_allocation_stats kinds[3];  ///< Heap, dynamic array and hash table counters
+};
+
+/// @cond INTERNAL
+inline static size_t __fp_stats_kind(uint16_t magic) FP_NOEXCEPT {
+	switch(magic) {
+		case FP_HEAP_MAGIC_NUMBER: return 0;
+		case FP_DYNARRAY_MAGIC_NUMBER: return 1;
+		case FP_HASH_TABLE_MAGIC_NUMBER: return 2;
+		default: return SIZE_MAX;
+	}
+}
+/// @endcond
+
+/**
+ * @brief Get a reference to the head of the list of every thread's counters
+ * @internal
+ */
+struct __FatPointerThreadStats** __fp_stats_threads_ref() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static struct __FatPointerThreadStats* head = NULL;
+	return &head;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Get the calling thread's counters, registering them the first time the thread allocates
+ * @internal
+ */
+struct __FatPointerThreadStats* __fp_stats_thread() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static thread_local struct __FatPointerThreadStats* stats = NULL;
+	if(stats) return stats;
+
+	stats = (struct __FatPointerThreadStats*)FP_ALLOCATION_FUNCTION(NULL, sizeof(struct __FatPointerThreadStats));
+	if(!stats) return NULL;
+	memset(stats, 0, sizeof(struct __FatPointerThreadStats));
+	struct __FatPointerThreadStats** head = __fp_stats_threads_ref();
+#if defined(_MSC_VER) && !defined(__clang__)
+	do stats->next = *head;
+	while(_InterlockedCompareExchangePointer((void* volatile*)head, stats, stats->next) != stats->next);
+#else
+	stats->next = __atomic_load_n(head, __ATOMIC_RELAXED);
+	while(!__atomic_compare_exchange_n(head, &stats->next, stats, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+#endif
+	return stats;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Record that a block of some kind was allocated (old_bytes == 0), resized, or freed (new_bytes == 0)
+ * @internal
+ */
+void __fp_stats_record_allocation(uint16_t magic, size_t old_bytes, size_t new_bytes) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	size_t kind = __fp_stats_kind(magic);
+	struct __FatPointerThreadStats* thread = __fp_stats_thread();
+	if(kind == SIZE_MAX || !thread) return;
+
+	struct fp_allocation_stats* stats = thread->kinds + kind;
+	if(old_bytes == 0) ++stats->allocations;
+	else if(new_bytes == 0) ++stats->frees;
+	else ++stats->reallocations;
+	// Blocks freed by a different thread than allocated them make a thread's live bytes "negative", the totals still add up
+	stats->bytes_live += new_bytes - old_bytes;
+	if((ptrdiff_t)stats->bytes_live > (ptrdiff_t)stats->peak_bytes)
+		stats->peak_bytes = stats->bytes_live;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Record that a dynamic array or hash table was grown to a new capacity
+ * @internal
+ */
+void __fp_stats_record_growth(uint16_t magic, size_t capacity_bytes) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	size_t kind = __fp_stats_kind(magic);
+	struct __FatPointerThreadStats* thread = __fp_stats_thread();
+	if(kind == SIZE_MAX || !thread) return;
+
+	size_t bucket = 0;
+	while(capacity_bytes >>= 1) ++bucket;
+	++thread->kinds[kind].growths;
+	++thread->kinds[kind].growth_histogram[bucket];
+}
+#else
+;
+#endif
+
+/**
+ * @brief Record that a hash table was doubled and rehashed
+ * @internal
+ */
+inline static void __fp_stats_record_rehash() FP_NOEXCEPT {
+	struct __FatPointerThreadStats* thread = __fp_stats_thread();
+	if(thread) ++thread->kinds[__fp_stats_kind(FP_HASH_TABLE_MAGIC_NUMBER)].rehashes;
+}
+
+/** \addtogroup capi
+ *  @{
+ */
+
+/**
+ * @brief Get the calling thread's allocation counters for one kind of container
+ * @param magic Magic number of the kind of container (FP_HEAP_MAGIC_NUMBER, FP_DYNARRAY_MAGIC_NUMBER or FP_HASH_TABLE_MAGIC_NUMBER)
+ * @return Counters of everything the calling thread allocated, resized or freed (zeroed for untracked magic numbers)
+ */
+inline static struct fp_allocation_stats fp_allocation_stats_thread(uint16_t magic) FP_NOEXCEPT {
+	struct fp_allocation_stats out;
+	memset(&out, 0, sizeof(out));
+	size_t kind = __fp_stats_kind(magic);
+	struct __FatPointerThreadStats* thread = __fp_stats_thread();
+	if(kind != SIZE_MAX && thread) out = thread->kinds[kind];
+	return out;
+}
+
+/**
+ * @brief Sum the allocation counters of every thread for one kind of container
+ * @param magic Magic number of the kind of container (FP_HEAP_MAGIC_NUMBER, FP_DYNARRAY_MAGIC_NUMBER or FP_HASH_TABLE_MAGIC_NUMBER)
+ * @return Counters of everything the program allocated, resized or freed (zeroed for untracked magic numbers)
+ *
+ * Every thread counts on its own, so recording stays cheap, and the counters are only summed here.
+ * Counts of threads which are still running may be slightly out of date and peak_bytes is the sum
+ * of each thread's peak (an upper bound of the program's peak).
+ *
+ * @code
+ * struct fp_allocation_stats arrays = fp_allocation_stats_total(FP_DYNARRAY_MAGIC_NUMBER);
+ * printf("%zu dynamic arrays live, grown %zu times, %zu bytes at peak\n",
+ *     arrays.allocations - arrays.frees, arrays.growths, arrays.peak_bytes);
+ * @endcode
+ */
+inline static struct fp_allocation_stats fp_allocation_stats_total(uint16_t magic) FP_NOEXCEPT {
+	struct fp_allocation_stats out;
+	memset(&out, 0, sizeof(out));
+	size_t kind = __fp_stats_kind(magic);
+	if(kind == SIZE_MAX) return out;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+	struct __FatPointerThreadStats* thread = *(struct __FatPointerThreadStats* volatile*)__fp_stats_threads_ref();
+#else
+	struct __FatPointerThreadStats* thread = __atomic_load_n(__fp_stats_threads_ref(), __ATOMIC_ACQUIRE);
+#endif
+	for( ; thread; thread = thread->next) {
+		const struct fp_allocation_stats* stats = thread->kinds + kind;
+		out.allocations += stats->allocations;
+		out.reallocations += stats->reallocations;
+		out.frees += stats->frees;
+		out.bytes_live += stats->bytes_live;
+		out.peak_bytes += stats->peak_bytes;
+		out.growths += stats->growths;
+		out.rehashes += stats->rehashes;
+		for(size_t i = 0; i < FP_ALLOCATION_STATS_HISTOGRAM_SIZE; ++i)
+			out.growth_histogram[i] += stats->growth_histogram[i];
+	}
+	return out;
+}
+
+/** @} */
+#else
+	#define __fp_stats_record_allocation(magic, old_bytes, new_bytes) ((void)0)
+	#define __fp_stats_record_growth(magic, capacity_bytes) ((void)0)
+	#define __fp_stats_record_rehash() ((void)0)
+#endif
+
+/**
+ * @brief Internal allocation function for fat pointers with aligned data
  * @param _p Existing fat pointer to reallocate (NULL for new allocation)
  * @param _size Size in bytes to allocate
+ * @param alignment Power of two the address _p + data_offset should be a multiple of (0 for no requirement),
+ *	existing allocations always keep the alignment they were created with
+ * @param data_offset Offset from the returned pointer to the data which should be aligned (for containers with extra headers)
+ * @param allocator Allocator to use for new allocations (NULL for the thread's default allocator),
+ *	existing allocations always stay with the allocator that created them
  * @return Fat pointer to allocated memory
+ *
+ * Aligned blocks are over-allocated by alignment - 1 bytes and the headers are shifted forward until the data
+ * lands on the requested boundary. If a reallocation moves the block to an address with a different
+ * misalignment the contents are shifted to match.
  * @internal
  */
-void* __fp_alloc(void* _p, size_t _size) FP_NOEXCEPT
+void* __fp_alloc_aligned(void* _p, size_t _size, size_t alignment, size_t data_offset, const struct fp_allocator* allocator) FP_NOEXCEPT
 #ifdef FP_IMPLEMENTATION
 {
 	if(_p == NULL && _size == 0) return NULL;
-	if(_size == 0)
-		return FP_ALLOCATION_FUNCTION(__fp_header(_p), 0);
+	struct __FatPointerAllocationHeader* a = _p == NULL ? NULL : __fp_allocation_header(_p);
+	uint8_t* block = NULL;
+	size_t old_padding = 0, old_allocation_size = 0, residue = 0;
+	if(a) {
+		allocator = a->allocator;
+		alignment = a->h.alignment_log2 ? ((size_t)1) << a->h.alignment_log2 : 0;
+		old_padding = a->h.alignment_padding;
+		old_allocation_size = a->allocation_size;
+		block = ((uint8_t*)a) - old_padding;
+		if(alignment) residue = ((uintptr_t)_p) & (alignment - 1); // Keep whatever was aligned aligned
+	} else {
+		if(allocator == NULL) allocator = *__fp_thread_allocator_ref();
+		if(alignment <= 1) alignment = 0;
+		assert((alignment & (alignment - 1)) == 0 && alignment <= FP_MAX_ALIGNMENT);
+		if(alignment) residue = (alignment - (data_offset & (alignment - 1))) & (alignment - 1);
+	}
+	// Only blocks straight from FP_ALLOCATION_FUNCTION are reported to the profiler, custom allocators (arenas, pools, ...)
+	//	hand out pieces of memory they report themselves, and release them without a call per block
+	if(_size == 0) {
+		if(allocator == NULL) FP_TRACE_FREE(block);
+		__fp_allocator_deallocate(allocator, block, old_allocation_size);
+		return NULL;
+	}
 
-	_p = _p == NULL ? _p : __fp_header(_p);
 #ifdef __cplusplus
 	_size = FP_MAX(_size, 8); // Since the C++ header assumes the buffer is 8 elements large, it will overwrite memory out to 8 bytes... thus we must reserve at least that much memory
 #endif
-	size_t size = FP_HEADER_SIZE + _size + 1;
-	uint8_t* p = (uint8_t*)FP_ALLOCATION_FUNCTION(_p, size);
-	if(!p) return 0;
-	p += FP_HEADER_SIZE;
+	size_t headers = FP_ALLOCATION_HEADER_SIZE + FP_HEADER_SIZE;
+	size_t slack = alignment ? alignment - 1 : 0;
+	size_t size = slack + headers + _size + 1;
+	uint8_t* old_block = block;
+	block = (uint8_t*)(block == NULL
+		? __fp_allocator_allocate(allocator, size)
+		: __fp_allocator_reallocate(allocator, block, old_allocation_size, size));
+	if(!block) return 0;
+	if(allocator == NULL) {
+		if(old_block) FP_TRACE_FREE(old_block);
+		FP_TRACE_ALLOCATION(block, size);
+	}
+
+	size_t padding = 0;
+	if(alignment) {
+		padding = (residue - ((uintptr_t)block + headers)) & (alignment - 1);
+		if(old_allocation_size && padding != old_padding) // The block moved to an address with a different misalignment
+			memmove(block + padding, block + old_padding, FP_MIN(old_allocation_size, size) - slack);
+	}
+
+	a = (struct __FatPointerAllocationHeader*)(block + padding);
+	a->allocator = allocator;
+	a->allocation_size = size;
+
+	uint8_t* p = ((uint8_t*)a) + headers;
 	auto h = __fp_header(p);
 	h->magic = FP_HEAP_MAGIC_NUMBER;
+	h->alignment_log2 = 0;
+	while((((size_t)1) << h->alignment_log2) < alignment) ++h->alignment_log2;
+	h->alignment_padding = (uint16_t)padding;
 	h->size = _size;
 	h->data[_size] = 0;
 	return p;
@@ -526,22 +993,94 @@ void* __fp_alloc(void* _p, size_t _size) FP_NOEXCEPT
 ;
 #endif
 
+/**
+ * @brief Internal allocation function which also records the allocation in the stats of a kind of container
+ * @param magic Magic number of the container the block holds (FP_ENABLE_ALLOCATION_STATS sorts its counters by it)
+ * @see __fp_alloc_aligned for the other parameters
+ * @internal
+ */
+inline static void* __fp_alloc_counted(void* _p, size_t _size, size_t alignment, size_t data_offset, const struct fp_allocator* allocator, uint16_t magic) FP_NOEXCEPT {
+#ifdef FP_ENABLE_ALLOCATION_STATS
+	size_t old_bytes = _p ? __fp_allocation_header(_p)->allocation_size : 0;
+	void* out = __fp_alloc_aligned(_p, _size, alignment, data_offset, allocator);
+	if(out || (_p && _size == 0))
+		__fp_stats_record_allocation(magic, old_bytes, out ? __fp_allocation_header(out)->allocation_size : 0);
+	return out;
+#else
+	(void)magic;
+	return __fp_alloc_aligned(_p, _size, alignment, data_offset, allocator);
+#endif
+}
+
+/**
+ * @brief Internal allocation function for fat pointers
+ * @param _p Existing fat pointer to reallocate (NULL for new allocation)
+ * @param _size Size in bytes to allocate
+ * @param allocator Allocator to use for new allocations (NULL for the thread's default allocator),
+ *	existing allocations always stay with the allocator that created them
+ * @return Fat pointer to allocated memory
+ * @internal
+ */
+inline static void* __fp_alloc_with_allocator(void* _p, size_t _size, const struct fp_allocator* allocator) FP_NOEXCEPT {
+	return __fp_alloc_counted(_p, _size, 0, 0, allocator, FP_HEAP_MAGIC_NUMBER);
+}
+
+/**
+ * @brief Internal allocation function for fat pointers
+ * @param _p Existing fat pointer to reallocate (NULL for new allocation)
+ * @param _size Size in bytes to allocate
+ * @return Fat pointer to allocated memory
+ * @internal
+ */
+inline static void* __fp_alloc(void* _p, size_t _size) FP_NOEXCEPT {
+	return __fp_alloc_with_allocator(_p, _size, NULL);
+}
+
 /**
  * @brief Internal reallocation function for fat pointers (properly updates the header for the specific type)
  * @param p Existing fat pointer
  * @param type_size Size of each element
  * @param count Number of elements
+ * @param allocator Allocator to use if p is NULL
  * @return Reallocated fat pointer
  * @internal
  */
-inline static void* __fp_realloc(void* p, size_t type_size, size_t count) FP_NOEXCEPT {
-	auto out = __fp_alloc(p, type_size * count);
+inline static void* __fp_realloc_with_allocator(void* p, size_t type_size, size_t count, const struct fp_allocator* allocator) FP_NOEXCEPT {
+	auto out = __fp_alloc_with_allocator(p, type_size * count, allocator);
 	auto h = __fp_header(out);
 	h->magic = FP_HEAP_MAGIC_NUMBER;
 	h->size = count;
 	return out;
 }
 
+/**
+ * @brief Internal reallocation function for fat pointers (properly updates the header for the specific type)
+ * @param p Existing fat pointer
+ * @param type_size Size of each element
+ * @param count Number of elements
+ * @return Reallocated fat pointer
+ * @internal
+ */
+inline static void* __fp_realloc(void* p, size_t type_size, size_t count) FP_NOEXCEPT {
+	return __fp_realloc_with_allocator(p, type_size, count, NULL);
+}
+
+/**
+ * @brief Internal allocation function for fat pointers with aligned data (properly updates the header for the specific type)
+ * @param type_size Size of each element
+ * @param count Number of elements
+ * @param alignment Alignment of the data in bytes (must be a power of two)
+ * @param allocator Allocator the memory is taken from (NULL for the thread's default allocator)
+ * @return Allocated fat pointer
+ * @internal
+ */
+inline static void* __fp_malloc_aligned(size_t type_size, size_t count, size_t alignment, const struct fp_allocator* allocator) FP_NOEXCEPT {
+	auto out = __fp_alloc_counted(NULL, type_size * count, alignment, 0, allocator, FP_HEAP_MAGIC_NUMBER);
+	if(!out) return NULL;
+	__fp_header(out)->size = count;
+	return out;
+}
+
 /** \addtogroup capi
  *  @{
  */
@@ -562,6 +1101,53 @@ inline static void* __fp_realloc(void* p, size_t type_size, size_t count) FP_NOE
  */
 #define fp_malloc(type, _size) ((type*)__fp_realloc(nullptr, sizeof(type), (_size)))
 
+/**
+ * @brief Allocate a typed fat pointer through a specific allocator
+ * @param type Element type
+ * @param _size Number of elements to allocate
+ * @param allocator Allocator the memory is taken from (NULL for the thread's default allocator)
+ * @return Typed pointer to allocated memory
+ *
+ * The allocator is remembered in the allocation, fp_realloc and fp_free will route back to it.
+ *
+ * @code{.cpp}
+ * int* data = fp_malloc_with_allocator(int, 100, &my_allocator);
+ * assert(fp_get_allocator(data) == &my_allocator);
+ * data = fp_realloc(int, data, 200); // Still uses my_allocator
+ * fp_free_and_null(data);
+ * @endcode
+ */
+#define fp_malloc_with_allocator(type, _size, allocator) ((type*)__fp_realloc_with_allocator(nullptr, sizeof(type), (_size), (allocator)))
+
+/**
+ * @brief Allocate a typed fat pointer whose data is aligned to a specific boundary
+ * @param type Element type
+ * @param _size Number of elements to allocate
+ * @param alignment Alignment of the data in bytes (a power of two, at most FP_MAX_ALIGNMENT)
+ * @return Typed pointer to aligned memory
+ *
+ * The header still sits directly in front of the data, so the pointer works with every fat pointer function.
+ * The alignment is remembered, fp_realloc keeps the data aligned.
+ *
+ * @code{.cpp}
+ * float* samples = fp_malloc_aligned(float, 1024, 32); // Ready for AVX2 aligned loads
+ * assert(((uintptr_t)samples) % 32 == 0);
+ * samples = fp_realloc(float, samples, 4096); // Still 32 byte aligned
+ * fp_free_and_null(samples);
+ * @endcode
+ */
+#define fp_malloc_aligned(type, _size, alignment) ((type*)__fp_malloc_aligned(sizeof(type), (_size), (alignment), NULL))
+
+/**
+ * @brief Allocate a typed fat pointer whose data is aligned to a specific boundary through a specific allocator
+ * @param type Element type
+ * @param _size Number of elements to allocate
+ * @param alignment Alignment of the data in bytes (a power of two, at most FP_MAX_ALIGNMENT)
+ * @param allocator Allocator the memory is taken from (NULL for the thread's default allocator)
+ * @return Typed pointer to aligned memory
+ */
+#define fp_malloc_aligned_with_allocator(type, _size, alignment, allocator) ((type*)__fp_malloc_aligned(sizeof(type), (_size), (alignment), (allocator)))
+
 /**
  * @brief Reallocate a fat pointer with a new size
  * @param type Element type
@@ -653,6 +1239,31 @@ FP_CONSTEXPR inline static bool fp_is_heap_allocated(const void* p) FP_NOEXCEPT
 	return fp_magic_number(p) == FP_HEAP_MAGIC_NUMBER || fp_magic_number(p) == FP_DYNARRAY_MAGIC_NUMBER;
 }
 
+/**
+ * @brief Get the allocator a heap-allocated fat pointer was created with
+ * @param p Fat pointer
+ * @return The allocator (NULL if p isn't heap allocated or uses FP_ALLOCATION_FUNCTION)
+ *
+ * @note Dynamic arrays store their allocator elsewhere, see fpda_get_allocator.
+ */
+inline static const struct fp_allocator* fp_get_allocator(const void* p) FP_NOEXCEPT {
+	if(fp_magic_number(p) != FP_HEAP_MAGIC_NUMBER) return NULL;
+	return __fp_allocation_header(p)->allocator;
+}
+
+/**
+ * @brief Get the alignment a heap-allocated fat pointer was created with
+ * @param p Fat pointer
+ * @return The requested alignment in bytes (0 if p isn't heap allocated or no alignment was requested)
+ *
+ * @note Dynamic arrays store their alignment elsewhere, see fpda_get_alignment.
+ */
+inline static size_t fp_get_alignment(const void* p) FP_NOEXCEPT {
+	if(fp_magic_number(p) != FP_HEAP_MAGIC_NUMBER) return 0;
+	uint8_t log2 = __fp_header(p)->alignment_log2;
+	return log2 ? ((size_t)1) << log2 : 0;
+}
+
 /**
  * @brief Free a heap-allocated fat pointer
  * @param p Fat pointer to free
@@ -965,6 +1576,204 @@ inline static void* __fp_clone(const void* ptr, size_t type_size) FP_NOEXCEPT {
 
 /** @} */
 
+/// @cond INTERNAL
+// Loads of possibly unaligned scalars
+inline static uint16_t __fp_load_u16(const void* p) FP_NOEXCEPT { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+inline static uint32_t __fp_load_u32(const void* p) FP_NOEXCEPT { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+inline static uint64_t __fp_load_u64(const void* p) FP_NOEXCEPT { uint64_t v; memcpy(&v, p, sizeof(v)); return v; }
+/// @endcond
+
+/**
+ * @brief Index of the lowest set bit of a (non-zero) mask
+ * @internal
+ */
+inline static size_t __fp_lowest_bit(uint32_t mask) FP_NOEXCEPT {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * @brief Index of the lowest set bit of a (non-zero) 64 bit mask
+ * @internal
+ */
+inline static size_t __fp_lowest_bit64(uint64_t mask) FP_NOEXCEPT {
+#if defined(_MSC_VER) && !defined(__clang__)
+	if((uint32_t)mask) return __fp_lowest_bit((uint32_t)mask);
+	return 32 + __fp_lowest_bit((uint32_t)(mask >> 32));
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+/**
+ * @brief Index of the highest set bit of a (non-zero) mask
+ * @internal
+ */
+inline static size_t __fp_highest_bit(uint32_t mask) FP_NOEXCEPT {
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanReverse(&index, mask);
+	return index;
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
+
+#if defined(FP_SIMD_X86) && defined(FP_IMPLEMENTATION)
+/// @cond INTERNAL
+// Generates a search kernel for one element width: each step compares a whole vector worth of elements against the
+//	broadcast needle and turns the comparison into a bitmask (type_size bits per element) whose lowest/highest bit is the hit
+#define __FP_DEFINE_FIND_KERNEL(name, attributes, vec_t, width, type_size, load, broadcast, equal, movemask, fix_mask)\
+	attributes static size_t name(const uint8_t* data, size_t count, const void* needle, bool reverse) FP_NOEXCEPT {\
+		const vec_t n = broadcast(needle);\
+		const size_t per = (width) / (type_size);\
+		if(!reverse) {\
+			size_t i = 0;\
+			for(; i + per <= count; i += per) {\
+				uint32_t mask = fix_mask((uint32_t)movemask(equal(load((const vec_t*)(data + i * (type_size))), n)));\
+				if(mask) return i + __fp_lowest_bit(mask) / (type_size);\
+			}\
+			for(; i < count; ++i)\
+				if(memcmp(data + i * (type_size), needle, (type_size)) == 0) return i;\
+		} else {\
+			size_t i = count;\
+			while(i >= per) {\
+				i -= per;\
+				uint32_t mask = fix_mask((uint32_t)movemask(equal(load((const vec_t*)(data + i * (type_size))), n)));\
+				if(mask) return i + __fp_highest_bit(mask) / (type_size);\
+			}\
+			while(i-- > 0)\
+				if(memcmp(data + i * (type_size), needle, (type_size)) == 0) return i;\
+		}\
+		return SIZE_MAX;\
+	}
+
+#define __fp_sse2_set1_1(p) _mm_set1_epi8((char)*(const uint8_t*)(p))
+#define __fp_sse2_set1_2(p) _mm_set1_epi16((short)__fp_load_u16(p))
+#define __fp_sse2_set1_4(p) _mm_set1_epi32((int)__fp_load_u32(p))
+#define __fp_sse2_set1_8(p) _mm_set1_epi64x((long long)__fp_load_u64(p))
+#define __fp_sse2_set1_16(p) _mm_loadu_si128((const __m128i*)(p))
+#define __fp_mask_identity(m) (m)
+inline static __m128i __fp_sse2_cmpeq_epi64(__m128i a, __m128i b) FP_NOEXCEPT { // SSE2 only compares 32 bit lanes... both halves need to match
+	__m128i eq = _mm_cmpeq_epi32(a, b);
+	return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+inline static uint32_t __fp_sse2_mask_16(uint32_t m) FP_NOEXCEPT { return m == 0xFFFF; }
+
+__FP_DEFINE_FIND_KERNEL(__fp_find_sse2_1, , __m128i, 16, 1, _mm_loadu_si128, __fp_sse2_set1_1, _mm_cmpeq_epi8, _mm_movemask_epi8, __fp_mask_identity)
+__FP_DEFINE_FIND_KERNEL(__fp_find_sse2_2, , __m128i, 16, 2, _mm_loadu_si128, __fp_sse2_set1_2, _mm_cmpeq_epi16, _mm_movemask_epi8, __fp_mask_identity)
+__FP_DEFINE_FIND_KERNEL(__fp_find_sse2_4, , __m128i, 16, 4, _mm_loadu_si128, __fp_sse2_set1_4, _mm_cmpeq_epi32, _mm_movemask_epi8, __fp_mask_identity)
+__FP_DEFINE_FIND_KERNEL(__fp_find_sse2_8, , __m128i, 16, 8, _mm_loadu_si128, __fp_sse2_set1_8, __fp_sse2_cmpeq_epi64, _mm_movemask_epi8, __fp_mask_identity)
+__FP_DEFINE_FIND_KERNEL(__fp_find_sse2_16, , __m128i, 16, 16, _mm_loadu_si128, __fp_sse2_set1_16, _mm_cmpeq_epi8, _mm_movemask_epi8, __fp_sse2_mask_16)
+
+#ifdef FP_SIMD_AVX2_DISPATCH
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#define __FP_AVX2_TARGET
+	#else
+		#define __FP_AVX2_TARGET __attribute__((target("avx2")))
+	#endif
+	#define __fp_avx2_set1_1(p) _mm256_set1_epi8((char)*(const uint8_t*)(p))
+	#define __fp_avx2_set1_2(p) _mm256_set1_epi16((short)__fp_load_u16(p))
+	#define __fp_avx2_set1_4(p) _mm256_set1_epi32((int)__fp_load_u32(p))
+	#define __fp_avx2_set1_8(p) _mm256_set1_epi64x((long long)__fp_load_u64(p))
+	#define __fp_avx2_set1_16(p) _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(p)))
+	inline static uint32_t __fp_avx2_mask_16(uint32_t m) FP_NOEXCEPT { return ((m & 0xFFFF) == 0xFFFF) | (((m >> 16) == 0xFFFF) << 16); }
+
+	__FP_DEFINE_FIND_KERNEL(__fp_find_avx2_1, __FP_AVX2_TARGET, __m256i, 32, 1, _mm256_loadu_si256, __fp_avx2_set1_1, _mm256_cmpeq_epi8, _mm256_movemask_epi8, __fp_mask_identity)
+	__FP_DEFINE_FIND_KERNEL(__fp_find_avx2_2, __FP_AVX2_TARGET, __m256i, 32, 2, _mm256_loadu_si256, __fp_avx2_set1_2, _mm256_cmpeq_epi16, _mm256_movemask_epi8, __fp_mask_identity)
+	__FP_DEFINE_FIND_KERNEL(__fp_find_avx2_4, __FP_AVX2_TARGET, __m256i, 32, 4, _mm256_loadu_si256, __fp_avx2_set1_4, _mm256_cmpeq_epi32, _mm256_movemask_epi8, __fp_mask_identity)
+	__FP_DEFINE_FIND_KERNEL(__fp_find_avx2_8, __FP_AVX2_TARGET, __m256i, 32, 8, _mm256_loadu_si256, __fp_avx2_set1_8, _mm256_cmpeq_epi64, _mm256_movemask_epi8, __fp_mask_identity)
+	__FP_DEFINE_FIND_KERNEL(__fp_find_avx2_16, __FP_AVX2_TARGET, __m256i, 32, 16, _mm256_loadu_si256, __fp_avx2_set1_16, _mm256_cmpeq_epi8, _mm256_movemask_epi8, __fp_avx2_mask_16)
+
+	inline static bool __fp_cpu_has_avx2() FP_NOEXCEPT {
+	#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 1);
+		if(!(info[2] & (1 << 27))) return false; // The OS doesn't save the AVX registers (OSXSAVE)
+		if((_xgetbv(0) & 6) != 6) return false;
+		__cpuidex(info, 7, 0);
+		return info[1] & (1 << 5);
+	#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+	#endif
+	}
+
+	// Whether the AVX2 kernels should be used. The CPU is only queried once, its answer is cached in an atomic
+	// (0 until known, then 1 without and 2 with AVX2) so threads racing to fill it in all store the same value
+	inline static bool __fp_simd_avx2() FP_NOEXCEPT {
+		static int cached = 0;
+	#if defined(_MSC_VER) && !defined(__clang__)
+		int state = *(volatile int*)&cached;
+		if(state == 0) *(volatile int*)&cached = state = 1 + __fp_cpu_has_avx2();
+	#else
+		int state = __atomic_load_n(&cached, __ATOMIC_RELAXED);
+		if(state == 0) __atomic_store_n(&cached, state = 1 + __fp_cpu_has_avx2(), __ATOMIC_RELAXED);
+	#endif
+		return state == 2;
+	}
+#endif // FP_SIMD_AVX2_DISPATCH
+/// @endcond
+#endif // FP_SIMD_X86 && FP_IMPLEMENTATION
+
+/**
+ * @brief Find the first (or last) element of an array whose bytes equal the needle's
+ * @param data First element to search
+ * @param count Number of elements to search
+ * @param needle Pointer to the value to find
+ * @param type_size Size in bytes of each element
+ * @param reverse Find the last matching element instead of the first
+ * @return Index of the matching element, or SIZE_MAX if no element matches
+ *
+ * Elements of 1, 2, 4, 8 or 16 bytes are compared a whole vector at a time on x86 (AVX2 when the CPU supports it,
+ * SSE2 otherwise), every other width (or platform) falls back to a memcmp per element. Define FP_DISABLE_SIMD to
+ * always use the fallback.
+ * @internal
+ */
+size_t __fp_find_element(const void* data, size_t count, const void* needle, size_t type_size, bool reverse) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	if(count == 0) return SIZE_MAX;
+
+#ifdef FP_SIMD_X86
+	typedef size_t(*kernel_t)(const uint8_t* data, size_t count, const void* needle, bool reverse);
+	static const kernel_t sse2[5] = {__fp_find_sse2_1, __fp_find_sse2_2, __fp_find_sse2_4, __fp_find_sse2_8, __fp_find_sse2_16};
+	#ifdef FP_SIMD_AVX2_DISPATCH
+	static const kernel_t avx2[5] = {__fp_find_avx2_1, __fp_find_avx2_2, __fp_find_avx2_4, __fp_find_avx2_8, __fp_find_avx2_16};
+	const kernel_t* kernels = __fp_simd_avx2() ? avx2 : sse2;
+	#else
+	const kernel_t* kernels = sse2;
+	#endif
+
+	switch(type_size) {
+		case 1: return kernels[0](bytes, count, needle, reverse);
+		case 2: return kernels[1](bytes, count, needle, reverse);
+		case 4: return kernels[2](bytes, count, needle, reverse);
+		case 8: return kernels[3](bytes, count, needle, reverse);
+		case 16: return kernels[4](bytes, count, needle, reverse);
+		default: break;
+	}
+#endif
+
+	if(!reverse) {
+		for(size_t i = 0; i < count; ++i)
+			if(memcmp(bytes + i * type_size, needle, type_size) == 0)
+				return i;
+	} else for(size_t i = count; i-- > 0; )
+		if(memcmp(bytes + i * type_size, needle, type_size) == 0)
+			return i;
+	return SIZE_MAX;
+}
+#else
+;
+#endif
+
 /**
  * @brief Internal implementation for checking if fat pointer contains a value
  * @param a Fat pointer to search
@@ -974,11 +1783,7 @@ inline static void* __fp_clone(const void* ptr, size_t type_size) FP_NOEXCEPT {
  * @internal
  */
 inline static bool __fp_contains(void* a, void* needle, size_t type_size) {
-	auto __fp_start = (char*)a;
-	for(auto iter = __fp_start; iter < __fp_start + fp_length(__fp_start) * type_size; iter += type_size)
-		if(memcmp(iter, needle, type_size) == 0)
-			return true;
-	return false;
+	return __fp_find_element(a, fp_length(a), needle, type_size, false) != SIZE_MAX;
 }
 
 /** \addtogroup capi
@@ -991,7 +1796,7 @@ inline static bool __fp_contains(void* a, void* needle, size_t type_size) {
  * @param needle Value to find
  * @return true if value found, false otherwise
  *
- * Uses memcmp for comparison, so works with any type.
+ * Compares the bytes of each element (like memcmp), so works with any type.
  *
  * @code{.cpp}
  * int* numbers = fp_malloc(int, 100);
@@ -1031,12 +1836,7 @@ inline static bool __fp_contains(void* a, void* needle, size_t type_size) {
  * @internal
  */
 inline static size_t __fp_find(void* a, void* needle, size_t type_size) {
-	auto __fp_start = (char*)a;
-	size_t index = 0;
-	for(auto iter = __fp_start; iter < __fp_start + fp_length(__fp_start) * type_size; iter += type_size, ++index)
-		if(memcmp(iter, needle, type_size) == 0)
-			return index;
-	return fp_not_found;
+	return __fp_find_element(a, fp_length(a), needle, type_size, false);
 }
 
 /** \addtogroup capi
@@ -1049,7 +1849,7 @@ inline static size_t __fp_find(void* a, void* needle, size_t type_size) {
  * @param needle Value to find
  * @return Index of first occurrence (size_t), or fp_not_found if not found
  *
- * Uses memcmp for comparison, so works with any type.
+ * Compares the bytes of each element (like memcmp), so works with any type.
  * Returns fp_not_found (SIZE_MAX) if the element is not present.
  *
  * @code{.cpp}
@@ -1083,15 +1883,7 @@ inline static size_t __fp_find(void* a, void* needle, size_t type_size) {
  * @internal
  */
 inline static size_t __fp_rfind(void* a, void* needle, size_t type_size) {
-	auto __fp_start = (char*)a;
-	size_t length = fp_length(__fp_start);
-	if(length == 0) return fp_not_found;
-
-	size_t index = length - 1;
-	for(auto iter = __fp_start + (length - 1) * type_size; iter >= __fp_start; iter -= type_size, --index)
-		if(memcmp(iter, needle, type_size) == 0)
-			return index;
-	return fp_not_found;
+	return __fp_find_element(a, fp_length(a), needle, type_size, true);
 }
 
 /** \addtogroup capi
@@ -1105,7 +1897,7 @@ inline static size_t __fp_rfind(void* a, void* needle, size_t type_size) {
  * @return Index of last occurrence (size_t), or fp_not_found if not found
  *
  * Searches backwards through the fat pointer, returning the index of the last
- * occurrence of the value. Uses memcmp for comparison, so works with any type.
+ * occurrence of the value. Compares the bytes of each element (like memcmp), so works with any type.
  * Returns fp_not_found (SIZE_MAX) if the element is not present.
  *
  * @code{.cpp}
@@ -1785,6 +1785,65 @@ namespace fp {
 		return fp_malloc(T, count);
 	}
 
+	/**
+	 * @brief Allocate a fat pointer through a specific allocator
+	 * @tparam T Element type
+	 * @param count Number of elements to allocate
+	 * @param allocator Allocator the memory is taken from (nullptr for the thread's default allocator)
+	 * @return New fat pointer, reallocations and free go through the same allocator
+	 *
+	 * @code{.cpp}
+	 * fp::auto_free arr = fp::malloc<int>(100, &my_allocator);
+	 * @endcode
+	 */
+	template<typename T>
+	inline pointer<T> malloc(size_t count, const fp_allocator* allocator) {
+		return fp_malloc_with_allocator(T, count, allocator);
+	}
+
+	/**
+	 * @brief Allocate a fat pointer whose data is aligned to a specific boundary
+	 * @tparam T Element type
+	 * @tparam Align Alignment of the data in bytes (a power of two, at most FP_MAX_ALIGNMENT)
+	 * @param count Number of elements to allocate
+	 * @param allocator Allocator the memory is taken from (nullptr for the thread's default allocator)
+	 * @return New fat pointer, reallocations keep the data aligned
+	 *
+	 * @code{.cpp}
+	 * fp::auto_free samples = fp::malloc_aligned<float, 32>(1024);
+	 * assert(((uintptr_t)samples.data()) % 32 == 0);
+	 * @endcode
+	 */
+	template<typename T, size_t Align>
+	inline pointer<T> malloc_aligned(size_t count = 1, const fp_allocator* allocator = nullptr) {
+		static_assert((Align & (Align - 1)) == 0 && Align <= FP_MAX_ALIGNMENT, "Alignment must be a power of two no larger than FP_MAX_ALIGNMENT");
+		return fp_malloc_aligned_with_allocator(T, count, Align, allocator);
+	}
+
+	/**
+	 * @brief Makes an allocator this thread's default allocator for as long as the scope is alive
+	 *
+	 * Every container created (without an explicit allocator) while the scope is alive allocates
+	 * through the given allocator, the previous default is restored when the scope is destroyed.
+	 *
+	 * @code{.cpp}
+	 * {
+	 *     fp::thread_allocator_scope scope(&request_allocator);
+	 *     fp::raii::dynarray<int> arr;
+	 *     arr.push_back(5); // Allocated by request_allocator
+	 * }
+	 * // Back to the previous default allocator
+	 * @endcode
+	 */
+	struct thread_allocator_scope {
+		const fp_allocator* previous;
+
+		thread_allocator_scope(const fp_allocator* allocator) noexcept : previous(fp_set_thread_allocator(allocator)) {}
+		thread_allocator_scope(const thread_allocator_scope&) = delete;
+		thread_allocator_scope& operator=(const thread_allocator_scope&) = delete;
+		~thread_allocator_scope() noexcept { fp_set_thread_allocator(previous); }
+	};
+
 	/**
 	 * @brief Reallocate a fat pointer with a new size
 	 * @tparam T Element type
@@ -2039,6 +2098,8 @@ namespace fp {
 		/// @brief Default header for stack-allocated arrays
 		constexpr static __FatPointerHeaderTruncated __default_header = {
 			.magic = FP_STACK_MAGIC_NUMBER,
+			.alignment_log2 = 0,
+			.alignment_padding = 0,
 			.size = N,
 		};
 
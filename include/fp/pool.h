@@ -0,0 +1,333 @@
+/**
+ * @file pool.h
+ * @brief Size class pool allocator for small fat pointers, dynamic arrays, strings and hash tables
+ *
+ * Most containers never grow past a couple hundred bytes, yet each one costs a full trip through
+ * malloc. A pool keeps a free list per size class and carves new blocks out of large chunks, so
+ * creating and freeing small containers is just a couple of pointer swaps. Blocks larger than
+ * FP_POOL_MAX_BLOCK_SIZE fall back to FP_ALLOCATION_FUNCTION.
+ *
+ * Every thread has its own pool (see fp_pool_thread_allocator), which can be made the default for
+ * everything the thread allocates:
+ *
+ * @section example_pool Pool Usage
+ * @code
+ * fp_set_thread_allocator(fp_pool_thread_allocator());
+ *
+ * for(each message) {
+ *     fp_string line = fp_string_format("%s: %d", name, value); // From the pool
+ *     fp_dynarray(fp_string_view) parts = fp_string_split(line, " "); // From the pool
+ *     // ...
+ *     fpda_free(parts); // Back onto the pool's free list
+ *     fp_string_free(line);
+ * }
+ *
+ * fp_set_thread_allocator(NULL);
+ * fp_pool_release_thread(); // Give the pool's chunks back before the thread exits
+ * @endcode
+ *
+ * @warning Pools are not synchronized, memory allocated from a pool must be resized and freed on the thread which owns the pool.
+ */
+
+#ifndef __LIB_FAT_POINTER_POOL_H__
+#define __LIB_FAT_POINTER_POOL_H__
+
+#include "pointer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FP_POOL_MIN_BLOCK_SIZE
+/// @brief Size in bytes of the smallest size class (must be a power of two, at least 16)
+#define FP_POOL_MIN_BLOCK_SIZE 32
+#endif
+
+#ifndef FP_POOL_SIZE_CLASS_COUNT
+/// @brief Number of (power of two) size classes, blocks larger than the largest class come from the heap
+#define FP_POOL_SIZE_CLASS_COUNT 5
+#endif
+
+/// @brief Size in bytes of the largest block a pool hands out itself
+#define FP_POOL_MAX_BLOCK_SIZE (FP_POOL_MIN_BLOCK_SIZE << (FP_POOL_SIZE_CLASS_COUNT - 1))
+
+#ifndef FP_POOL_CHUNK_SIZE
+/// @brief Size in bytes of the chunks a pool carves its blocks out of
+#define FP_POOL_CHUNK_SIZE (64 * 1024)
+#endif
+
+/**
+ * @brief Header of a chunk of memory owned by a pool
+ *
+ * Layout:
+ * [__FatPoolChunk][blocks...]
+ * @internal
+ */
+struct __FatPoolChunk {
+	struct __FatPoolChunk* previous; ///< Chunk allocated before this one (NULL for the first)
+	size_t size;                     ///< Size in bytes of the chunk (including this header)
+};
+
+/**
+ * @brief Size class pool allocator
+ *
+ * Create with fp_pool_create and destroy with fp_pool_release, or use the calling thread's pool through fp_pool_thread_allocator.
+ */
+struct fp_pool {
+	struct fp_allocator allocator;                  ///< Allocator handle (state points back at this pool)
+	void* free_lists[FP_POOL_SIZE_CLASS_COUNT];     ///< Singly linked list of free blocks for each size class
+	struct __FatPoolChunk* chunk;                   ///< Most recently allocated chunk
+	uint8_t* top;                                   ///< Next uncarved byte in the current chunk
+	uint8_t* end;                                   ///< End of the current chunk
+};
+
+/// @cond INTERNAL
+inline static size_t __fp_pool_size_class(size_t size) FP_NOEXCEPT {
+	size_t class_ = 0;
+	for(size_t class_size = FP_POOL_MIN_BLOCK_SIZE; class_size < size; class_size <<= 1)
+		++class_;
+	return class_;
+}
+/// @endcond
+
+/**
+ * @brief Pool fp_allocator::allocate implementation
+ * @internal
+ */
+void* __fp_pool_allocate(void* state, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(size > FP_POOL_MAX_BLOCK_SIZE) {
+		void* large = FP_ALLOCATION_FUNCTION(NULL, size);
+		if(large) FP_TRACE_ALLOCATION(large, size);
+		return large;
+	}
+
+	struct fp_pool* pool = (struct fp_pool*)state;
+	size_t class_ = __fp_pool_size_class(size);
+	void* out = pool->free_lists[class_];
+	if(out) {
+		pool->free_lists[class_] = *(void**)out;
+		return out;
+	}
+
+	size_t class_size = ((size_t)FP_POOL_MIN_BLOCK_SIZE) << class_;
+	if(pool->chunk == NULL || (size_t)(pool->end - pool->top) < class_size) {
+		// Whatever is left of the current chunk is too small for this class... hand it out to the smaller classes
+		for(size_t i = class_; i-- > 0 && pool->chunk; ) {
+			size_t small = ((size_t)FP_POOL_MIN_BLOCK_SIZE) << i;
+			while((size_t)(pool->end - pool->top) >= small) {
+				*(void**)pool->top = pool->free_lists[i];
+				pool->free_lists[i] = pool->top;
+				pool->top += small;
+			}
+		}
+
+		struct __FatPoolChunk* chunk = (struct __FatPoolChunk*)FP_ALLOCATION_FUNCTION(NULL, FP_POOL_CHUNK_SIZE);
+		if(!chunk) return NULL;
+		FP_TRACE_ALLOCATION(chunk, FP_POOL_CHUNK_SIZE);
+		chunk->previous = pool->chunk;
+		chunk->size = FP_POOL_CHUNK_SIZE;
+		pool->chunk = chunk;
+		pool->top = ((uint8_t*)chunk) + FP_POOL_MIN_BLOCK_SIZE; // Skip the header while keeping blocks as aligned as the chunk
+		pool->end = ((uint8_t*)chunk) + FP_POOL_CHUNK_SIZE;
+	}
+
+	out = pool->top;
+	pool->top += class_size;
+	return out;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Pool fp_allocator::deallocate implementation (pushes the block onto its size class's free list)
+ * @internal
+ */
+void __fp_pool_deallocate(void* state, void* p, size_t size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(size > FP_POOL_MAX_BLOCK_SIZE) {
+		FP_TRACE_FREE(p);
+		FP_ALLOCATION_FUNCTION(p, 0);
+		return;
+	}
+
+	struct fp_pool* pool = (struct fp_pool*)state;
+	size_t class_ = __fp_pool_size_class(size);
+	*(void**)p = pool->free_lists[class_];
+	pool->free_lists[class_] = p;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Pool fp_allocator::reallocate implementation (stays in place while the size class doesn't change)
+ * @internal
+ */
+void* __fp_pool_reallocate(void* state, void* p, size_t old_size, size_t new_size) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(old_size > FP_POOL_MAX_BLOCK_SIZE && new_size > FP_POOL_MAX_BLOCK_SIZE) {
+		void* out = FP_ALLOCATION_FUNCTION(p, new_size);
+		if(out) {
+			FP_TRACE_FREE(p);
+			FP_TRACE_ALLOCATION(out, new_size);
+		}
+		return out;
+	}
+	if(old_size <= FP_POOL_MAX_BLOCK_SIZE && new_size <= FP_POOL_MAX_BLOCK_SIZE
+		&& __fp_pool_size_class(old_size) == __fp_pool_size_class(new_size))
+		return p;
+
+	void* out = __fp_pool_allocate(state, new_size);
+	if(!out) return NULL;
+	memcpy(out, p, old_size < new_size ? old_size : new_size);
+	__fp_pool_deallocate(state, p, old_size);
+	return out;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Set up a pool in place
+ * @internal
+ */
+inline static void __fp_pool_initialize(struct fp_pool* pool) FP_NOEXCEPT {
+	memset(pool, 0, sizeof(struct fp_pool));
+	pool->allocator.allocate = __fp_pool_allocate;
+	pool->allocator.reallocate = __fp_pool_reallocate;
+	pool->allocator.deallocate = __fp_pool_deallocate;
+	pool->allocator.state = pool;
+}
+
+/**
+ * @brief Give every chunk of a pool back, leaving the pool empty (but usable)
+ * @internal
+ */
+void __fp_pool_release_chunks(struct fp_pool* pool) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct __FatPoolChunk* chunk = pool->chunk;
+	while(chunk) {
+		struct __FatPoolChunk* previous = chunk->previous;
+		FP_TRACE_FREE(chunk);
+		FP_ALLOCATION_FUNCTION(chunk, 0);
+		chunk = previous;
+	}
+	__fp_pool_initialize(pool);
+}
+#else
+;
+#endif
+
+/**
+ * @brief Get a reference to the calling thread's pool
+ * @internal
+ */
+struct fp_pool* __fp_pool_thread_ref() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	static thread_local struct fp_pool pool;
+	if(pool.allocator.state == NULL) __fp_pool_initialize(&pool);
+	return &pool;
+}
+#else
+;
+#endif
+
+/** \addtogroup capi
+ *  @{
+ */
+
+/**
+ * @brief Create a new pool
+ * @return The new pool (or NULL if it could not be allocated)
+ *
+ * Chunks are only allocated once memory is first requested from the pool.
+ *
+ * @code
+ * struct fp_pool* pool = fp_pool_create();
+ * fp_dynarray(int) small = fpda_malloc_with_allocator(int, 4, fp_pool_allocator(pool));
+ * fpda_free(small); // Back onto the pool's free list
+ * fp_pool_release(pool);
+ * @endcode
+ */
+struct fp_pool* fp_pool_create() FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	struct fp_pool* pool = (struct fp_pool*)FP_ALLOCATION_FUNCTION(NULL, sizeof(struct fp_pool));
+	if(!pool) return NULL;
+	__fp_pool_initialize(pool);
+	return pool;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Get the allocator handle of a pool
+ * @param pool The pool
+ * @return Allocator which can be passed to fp_malloc_with_allocator, fpda_malloc_with_allocator, fp_set_thread_allocator, etc...
+ */
+inline static const struct fp_allocator* fp_pool_allocator(const struct fp_pool* pool) FP_NOEXCEPT {
+	return &pool->allocator;
+}
+
+/**
+ * @brief Get the allocator handle of the calling thread's pool
+ * @return Allocator which can be passed to fp_malloc_with_allocator, fpda_malloc_with_allocator, fp_set_thread_allocator, etc...
+ *
+ * @code
+ * const struct fp_allocator* previous = fp_set_thread_allocator(fp_pool_thread_allocator());
+ * fp_string greeting = fp_string_format("Hello %s", name); // From this thread's pool
+ * fp_string_free(greeting);
+ * fp_set_thread_allocator(previous);
+ * @endcode
+ */
+inline static const struct fp_allocator* fp_pool_thread_allocator() FP_NOEXCEPT {
+	return fp_pool_allocator(__fp_pool_thread_ref());
+}
+
+/**
+ * @brief Free a pool and everything which was allocated from it
+ * @param pool The pool (invalid after this call)
+ *
+ * @note Blocks larger than FP_POOL_MAX_BLOCK_SIZE come from the heap and must still be freed individually.
+ */
+void fp_pool_release(struct fp_pool* pool) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	if(!pool) return;
+	__fp_pool_release_chunks(pool);
+	FP_ALLOCATION_FUNCTION(pool, 0);
+}
+#else
+;
+#endif
+
+/**
+ * @brief Release a pool and set the pointer to NULL
+ * @param pool The pool
+ */
+#define fp_pool_release_and_null(pool) (fp_pool_release(pool), pool = NULL)
+
+/**
+ * @brief Give the calling thread's pool memory back (everything allocated from it becomes invalid)
+ *
+ * Thread local pools are never freed automatically, call this before a thread which used its pool exits.
+ */
+inline static void fp_pool_release_thread() FP_NOEXCEPT {
+	__fp_pool_release_chunks(__fp_pool_thread_ref());
+}
+
+/** @} */
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // __LIB_FAT_POINTER_POOL_H__
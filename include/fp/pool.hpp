@@ -0,0 +1,64 @@
+/**
+ * @file pool.hpp
+ * @brief C++ wrapper for size class pool allocators
+ *
+ * @code{.cpp}
+ * auto scope = fp::pool::make_thread_current(); // Everything this thread allocates comes from its pool
+ * for(auto& message: messages) {
+ *     fp::raii::string line = fp::string::format("{}: {}", message.name, message.value); // From the pool
+ *     // ...
+ * } // line goes back onto the pool's free list
+ * @endcode
+ */
+
+#pragma once
+
+#include "pointer.hpp"
+#include "pool.h"
+
+namespace fp {
+	/**
+	 * @brief Owning wrapper around an fp_pool
+	 *
+	 * The pool (and everything allocated from it) is released when the wrapper is destroyed.
+	 */
+	struct pool {
+		fp_pool* raw;
+
+		/**
+		 * @brief Create a new pool
+		 */
+		pool() noexcept : raw(fp_pool_create()) {}
+		pool(const pool&) = delete;
+		pool(pool&& o) noexcept : raw(std::exchange(o.raw, nullptr)) {}
+		pool& operator=(const pool&) = delete;
+		pool& operator=(pool&& o) noexcept { std::swap(raw, o.raw); return *this; }
+		~pool() noexcept { if(raw) fp_pool_release(raw); }
+
+		/**
+		 * @brief Get the allocator handle of this pool
+		 * @return Allocator which can be passed to fp::malloc, fp::dynarray::with_allocator, hash table configs, etc...
+		 */
+		inline const fp_allocator* allocator() const noexcept { return fp_pool_allocator(raw); }
+
+		/**
+		 * @brief Make this pool the thread's default allocator until the returned scope is destroyed
+		 * @return Scope object restoring the previous default allocator on destruction
+		 */
+		[[nodiscard]] inline thread_allocator_scope make_current() const noexcept { return {allocator()}; }
+
+		/**
+		 * @brief Make the calling thread's own pool its default allocator until the returned scope is destroyed
+		 * @return Scope object restoring the previous default allocator on destruction
+		 *
+		 * @code{.cpp}
+		 * {
+		 *     auto scope = fp::pool::make_thread_current();
+		 *     fp::raii::dynarray<int> arr;
+		 *     arr.push_back(1); // Allocated from the thread's pool
+		 * }
+		 * @endcode
+		 */
+		[[nodiscard]] inline static thread_allocator_scope make_thread_current() noexcept { return {fp_pool_thread_allocator()}; }
+	};
+}
@@ -0,0 +1,66 @@
+/**
+ * @file profile.h
+ * @brief Optional Tracy instrumentation of the library's hot paths
+ *
+ * When FP_ENABLE_PROFILING is defined (the CMake option of the same name defines it for everything
+ * linking against libfp) growth, rehashing, string searching/replacing/splitting and formatting open
+ * Tracy zones, and every block libfp gets from FP_ALLOCATION_FUNCTION (including the chunks backing
+ * arenas and pools, but not the pieces they hand out) is reported to Tracy's memory profiler, so
+ * libfp shows up in the captures of the programs using it. Otherwise every macro compiles to nothing.
+ *
+ * Defining FP_AGGRESSIVE_PROFILING additionally instruments the small functions which are called
+ * so often that the zones themselves start to dominate the capture.
+ *
+ * @note C builds need GCC or Clang (zones are closed with __attribute__((cleanup))), other C compilers only get allocation tracking.
+ */
+
+#ifndef __LIB_FAT_POINTER_PROFILE_H__
+#define __LIB_FAT_POINTER_PROFILE_H__
+
+#ifdef FP_ENABLE_PROFILING
+	#ifdef __cplusplus
+		#include <tracy/Tracy.hpp>
+
+		#define FP_ZONE_SCOPED ZoneScoped
+		#define FP_ZONE_SCOPED_NAMED(name) ZoneScopedN(name)
+		#define FP_FRAME_MARK FrameMark
+		#define FP_TRACE_ALLOCATION(p, size) TracyAlloc((p), (size))
+		#define FP_TRACE_FREE(p) TracyFree((p))
+	#else
+		#include <tracy/TracyC.h>
+
+		#if defined(__GNUC__) || defined(__clang__)
+			/// @cond INTERNAL
+			inline static void __fp_zone_end(TracyCZoneCtx* ctx) { TracyCZoneEnd(*ctx); }
+			/// @endcond
+			#define FP_ZONE_SCOPED TracyCZone(__fp_zone, 1);\
+				TracyCZoneCtx __fp_zone_guard __attribute__((cleanup(__fp_zone_end))) = __fp_zone
+			#define FP_ZONE_SCOPED_NAMED(name) TracyCZoneN(__fp_zone, name, 1);\
+				TracyCZoneCtx __fp_zone_guard __attribute__((cleanup(__fp_zone_end))) = __fp_zone
+		#else
+			#define FP_ZONE_SCOPED ((void)0)
+			#define FP_ZONE_SCOPED_NAMED(name) ((void)0)
+		#endif
+		#define FP_FRAME_MARK TracyCFrameMark
+		#define FP_TRACE_ALLOCATION(p, size) TracyCAlloc((p), (size))
+		#define FP_TRACE_FREE(p) TracyCFree((p))
+	#endif
+
+	#ifdef FP_AGGRESSIVE_PROFILING
+		#define FP_ZONE_SCOPED_AGGRO FP_ZONE_SCOPED
+		#define FP_ZONE_SCOPED_NAMED_AGGRO(name) FP_ZONE_SCOPED_NAMED(name)
+	#else
+		#define FP_ZONE_SCOPED_AGGRO ((void)0)
+		#define FP_ZONE_SCOPED_NAMED_AGGRO(name) ((void)0)
+	#endif // FP_AGGRESSIVE_PROFILING
+#else // FP_ENABLE_PROFILING
+	#define FP_ZONE_SCOPED ((void)0)
+	#define FP_ZONE_SCOPED_NAMED(name) ((void)0)
+	#define FP_ZONE_SCOPED_AGGRO ((void)0)
+	#define FP_ZONE_SCOPED_NAMED_AGGRO(name) ((void)0)
+	#define FP_FRAME_MARK ((void)0)
+	#define FP_TRACE_ALLOCATION(p, size) ((void)0)
+	#define FP_TRACE_FREE(p) ((void)0)
+#endif
+
+#endif // __LIB_FAT_POINTER_PROFILE_H__
@@ -413,9 +413,10 @@ inline static fp_string __fp_string_view_concatenate_inplace(fp_string* a, const
 	size_t sizeA = fp_string_length(*a);
 	size_t sizeB = fp_view_length(b);
 	if(sizeA + sizeB == 0) return nullptr;
-	fpda_resize(*a, sizeA + sizeB);
+	fpda_grow(*a, sizeB); // Geometric growth, repeated appends are amortized O(1)
 
 	memcpy(*a + sizeA, fp_view_data(char, b), sizeB);
+	(*a)[sizeA + sizeB] = 0; // Dynamic arrays always have room for a terminator past their capacity
 	return *a;
 }
 
@@ -611,12 +612,163 @@ inline static fp_string fp_string_append_impl(fp_string* str, char c) FP_NOEXCEP
  */
 #define fp_string_append(str, c) fp_string_append_impl(&str, (c))
 
+/**
+ * @brief Count the codepoints of a UTF-8 string
+ * @param view UTF-8 encoded string view
+ * @return Number of codepoints (the number of bytes which are not continuation bytes)
+ *
+ * Counts 16 bytes at a time with SSE2 on x86. The string is not validated, on invalid UTF-8 the count
+ * is that of the lead and ASCII bytes.
+ *
+ * @code
+ * assert(fp_string_view_codepoint_count(fp_string_view_from_literal("Hello, 世界")) == 9);
+ * @endcode
+ */
+size_t fp_string_view_codepoint_count(const fp_string_view view) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	const uint8_t* s = fp_view_data(uint8_t, view);
+	size_t n = fp_view_size(view), i = 0, count = 0;
+#ifdef FP_SIMD_X86
+	const __m128i continuation_limit = _mm_set1_epi8((char)0xBF); // As signed bytes continuations are [-128, -65]
+	for(; i + 16 <= n; i += 16) {
+		uint32_t lead = (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_loadu_si128((const __m128i*)(s + i)), continuation_limit));
+	#if defined(_MSC_VER) && !defined(__clang__)
+		count += __popcnt(lead);
+	#else
+		count += __builtin_popcount(lead);
+	#endif
+	}
+#endif
+	for(; i < n; ++i)
+		count += (s[i] & 0xC0) != 0x80;
+	return count;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Decode (and validate) the UTF-8 sequence starting a string
+ * @param s First byte of the sequence
+ * @param n Number of bytes available
+ * @param codepoint Set to the decoded codepoint
+ * @return Length of the sequence, or 0 if it is truncated, overlong, a surrogate or above U+10FFFF
+ * @internal
+ */
+inline static size_t __fp_utf8_decode_one(const uint8_t* s, size_t n, uint32_t* codepoint) FP_NOEXCEPT {
+	uint8_t b0 = s[0];
+	if(b0 < 0x80) { *codepoint = b0; return 1; }
+	if(b0 < 0xC2) return 0; // Continuation byte or overlong two byte sequence
+	if(b0 < 0xE0) {
+		if(n < 2 || (s[1] & 0xC0) != 0x80) return 0;
+		*codepoint = ((uint32_t)(b0 & 0x1F) << 6) | (s[1] & 0x3F);
+		return 2;
+	}
+	if(b0 < 0xF0) {
+		if(n < 3 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80) return 0;
+		if((b0 == 0xE0 && s[1] < 0xA0) || (b0 == 0xED && s[1] > 0x9F)) return 0; // Overlong or surrogate
+		*codepoint = ((uint32_t)(b0 & 0x0F) << 12) | ((uint32_t)(s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+		return 3;
+	}
+	if(b0 < 0xF5) {
+		if(n < 4 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80 || (s[3] & 0xC0) != 0x80) return 0;
+		if((b0 == 0xF0 && s[1] < 0x90) || (b0 == 0xF4 && s[1] > 0x8F)) return 0; // Overlong or above U+10FFFF
+		*codepoint = ((uint32_t)(b0 & 0x07) << 18) | ((uint32_t)(s[1] & 0x3F) << 12) | ((uint32_t)(s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+		return 4;
+	}
+	return 0;
+}
+
+#if defined(FP_SIMD_X86) && defined(FP_IMPLEMENTATION)
+/// @cond INTERNAL
+// Generates a UTF-8 decoder: blocks of pure ASCII are widened to codepoints a vector at a time, blocks containing
+//	other bytes are decoded (and validated) one sequence at a time
+#define __FP_DEFINE_UTF8_DECODE_KERNEL(name, attributes, vec_t, width, load, movemask, widen_store)\
+	attributes static size_t name(const uint8_t* s, size_t n, uint32_t* out) FP_NOEXCEPT {\
+		size_t i = 0, written = 0;\
+		while(i < n) {\
+			if(i + (width) <= n) {\
+				vec_t block = load((const vec_t*)(s + i));\
+				if(movemask(block) == 0) {\
+					widen_store(out + written, block);\
+					i += (width); written += (width);\
+					continue;\
+				}\
+			}\
+			for(size_t block_end = i + (width) < n ? i + (width) : n; i < block_end; ++written) {\
+				size_t length = __fp_utf8_decode_one(s + i, n - i, out + written);\
+				if(length == 0) return SIZE_MAX;\
+				i += length;\
+			}\
+		}\
+		return written;\
+	}
+
+inline static void __fp_utf8_widen_sse2(uint32_t* out, __m128i block) FP_NOEXCEPT {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i low = _mm_unpacklo_epi8(block, zero), high = _mm_unpackhi_epi8(block, zero);
+	_mm_storeu_si128((__m128i*)out + 0, _mm_unpacklo_epi16(low, zero));
+	_mm_storeu_si128((__m128i*)out + 1, _mm_unpackhi_epi16(low, zero));
+	_mm_storeu_si128((__m128i*)out + 2, _mm_unpacklo_epi16(high, zero));
+	_mm_storeu_si128((__m128i*)out + 3, _mm_unpackhi_epi16(high, zero));
+}
+__FP_DEFINE_UTF8_DECODE_KERNEL(__fp_utf8_decode_sse2, , __m128i, 16, _mm_loadu_si128, _mm_movemask_epi8, __fp_utf8_widen_sse2)
+
+#ifdef FP_SIMD_AVX2_DISPATCH
+__FP_AVX2_TARGET inline static void __fp_utf8_widen_avx2(uint32_t* out, __m256i block) FP_NOEXCEPT {
+	__m128i low = _mm256_castsi256_si128(block), high = _mm256_extracti128_si256(block, 1);
+	_mm256_storeu_si256((__m256i*)out + 0, _mm256_cvtepu8_epi32(low));
+	_mm256_storeu_si256((__m256i*)out + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+	_mm256_storeu_si256((__m256i*)out + 2, _mm256_cvtepu8_epi32(high));
+	_mm256_storeu_si256((__m256i*)out + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+}
+__FP_DEFINE_UTF8_DECODE_KERNEL(__fp_utf8_decode_avx2, __FP_AVX2_TARGET, __m256i, 32, _mm256_loadu_si256, _mm256_movemask_epi8, __fp_utf8_widen_avx2)
+#endif
+/// @endcond
+#endif // FP_SIMD_X86 && FP_IMPLEMENTATION
+
+/**
+ * @brief Decode and validate UTF-8 into a buffer of codepoints
+ * @param s UTF-8 bytes
+ * @param n Number of bytes
+ * @param out Buffer with room for at least fp_string_view_codepoint_count codepoints
+ * @return Number of codepoints written, or SIZE_MAX if the input is not valid UTF-8
+ * @internal
+ */
+size_t __fp_utf8_decode(const uint8_t* s, size_t n, uint32_t* out) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+#ifdef FP_SIMD_X86
+	typedef size_t(*kernel_t)(const uint8_t* s, size_t n, uint32_t* out);
+	#ifdef FP_SIMD_AVX2_DISPATCH
+	const kernel_t kernel = __fp_simd_avx2() ? __fp_utf8_decode_avx2 : __fp_utf8_decode_sse2;
+	#else
+	const kernel_t kernel = __fp_utf8_decode_sse2;
+	#endif
+	return kernel(s, n, out);
+#else
+	size_t i = 0, written = 0;
+	for(; i < n; ++written) {
+		size_t length = __fp_utf8_decode_one(s + i, n - i, out + written);
+		if(length == 0) return SIZE_MAX;
+		i += length;
+	}
+	return written;
+#endif
+}
+#else
+;
+#endif
+
 /**
  * @brief Convert string view to UTF-32 codepoints
  * @param view UTF-8 encoded string view
  * @return Dynamic array of UTF-32 codepoints (must be freed), or nullptr on error
  *
- * Decodes UTF-8 sequences into Unicode codepoints. Returns nullptr if invalid UTF-8 is encountered.
+ * Decodes UTF-8 sequences into Unicode codepoints. Returns nullptr if invalid UTF-8 is encountered (truncated
+ * sequences, stray continuation bytes, overlong encodings, surrogates or codepoints above U+10FFFF). The output is
+ * allocated once from a vectorized count of the codepoints, and runs of ASCII are widened a whole vector at a time.
  *
  * @code
  * fp_string_view text = fp_string_view_from_literal("Hello 🌍!");
@@ -637,41 +789,17 @@ inline static fp_string fp_string_append_impl(fp_string* str, char c) FP_NOEXCEP
  * @endcode
  */
 inline static fp_dynarray(uint32_t) fp_string_view_to_codepoints(const fp_string_view view) {
-	const unsigned char *s = (const unsigned char *)fp_view_data(char, view);
-	fp_dynarray(uint32_t) out = nullptr;
-
-	for(size_t i = 0; i < fp_view_size(view); ) {
-		uint32_t codepoint = 0;
-		if (*s < 0x80) {
-			// 1-byte (ASCII)
-			codepoint = *s++;
-			++i;
-		} else if ((*s >> 5) == 0x6) {
-			// 2-byte sequence
-			codepoint = (*s++ & 0x1F) << 6;
-			codepoint |= (*s++ & 0x3F);
-			i += 2;
-		} else if ((*s >> 4) == 0xE) {
-			// 3-byte sequence
-			codepoint = (*s++ & 0x0F) << 12;
-			codepoint |= (*s++ & 0x3F) << 6;
-			codepoint |= (*s++ & 0x3F);
-			i += 3;
-		} else if ((*s >> 3) == 0x1E) {
-			// 4-byte sequence
-			codepoint = (*s++ & 0x07) << 18;
-			codepoint |= (*s++ & 0x3F) << 12;
-			codepoint |= (*s++ & 0x3F) << 6;
-			codepoint |= (*s++ & 0x3F);
-			i += 4;
-		} else {
-			if(out) fpda_free_and_null(out);
-			return nullptr;
-		}
+	FP_ZONE_SCOPED;
+	size_t count = fp_string_view_codepoint_count(view);
+	if(count == 0) return nullptr;
 
-		fpda_push_back(out, codepoint);
+	fp_dynarray(uint32_t) out = nullptr;
+	fpda_grow_to_size(out, count);
+	size_t decoded = __fp_utf8_decode(fp_view_data(uint8_t, view), fp_view_size(view), out);
+	if(decoded != count) { // Invalid (a valid string decodes to exactly one codepoint per lead byte)
+		fpda_free_and_null(out);
+		return nullptr;
 	}
-
 	return out;
 }
 
@@ -737,11 +865,106 @@ inline static size_t fp_encode_utf8(uint32_t codepoint, char out[4]) {
 	return 0;  // Invalid code point
 }
 
+/**
+ * @brief Get the length in bytes of the UTF-8 encoding of some codepoints
+ * @param codepoints View of UTF-32 codepoints
+ * @return Number of bytes fp_codepoints_view_to_string produces, or SIZE_MAX if a codepoint is above U+10FFFF
+ *
+ * Classifies four codepoints at a time with SSE2 on x86.
+ */
+size_t fp_codepoints_view_utf8_length(fp_view(uint32_t) codepoints) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	const uint32_t* in = fp_view_data(uint32_t, codepoints);
+	size_t count = fp_view_size(codepoints), i = 0, length = count;
+#ifdef FP_SIMD_X86
+	// SSE2 only compares signed lanes, flipping the top bit turns that into an unsigned compare
+	const __m128i flip = _mm_set1_epi32(INT32_MIN);
+	const __m128i two = _mm_set1_epi32(0x7F ^ INT32_MIN), three = _mm_set1_epi32(0x7FF ^ INT32_MIN);
+	const __m128i four = _mm_set1_epi32(0xFFFF ^ INT32_MIN), invalid = _mm_set1_epi32(0x10FFFF ^ INT32_MIN);
+	__m128i extra = _mm_setzero_si128(), bad = _mm_setzero_si128();
+	for(; i + 4 <= count; i += 4) {
+		__m128i c = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + i)), flip);
+		extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(c, two)); // Each comparison is -1 where true
+		extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(c, three));
+		extra = _mm_sub_epi32(extra, _mm_cmpgt_epi32(c, four));
+		bad = _mm_or_si128(bad, _mm_cmpgt_epi32(c, invalid));
+		if(((i + 4) & (((size_t)1 << 30) - 1)) == 0) { // Flush before the 32 bit lanes could overflow
+			uint32_t lanes[4];
+			_mm_storeu_si128((__m128i*)lanes, extra);
+			length += (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+			extra = _mm_setzero_si128();
+		}
+	}
+	uint32_t lanes[4];
+	_mm_storeu_si128((__m128i*)lanes, extra);
+	length += (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	if(_mm_movemask_epi8(bad)) return SIZE_MAX;
+#endif
+	for(; i < count; ++i) {
+		if(in[i] > 0x10FFFF) return SIZE_MAX;
+		length += (in[i] > 0x7F) + (in[i] > 0x7FF) + (in[i] > 0xFFFF);
+	}
+	return length;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Encode codepoints into a buffer of exactly fp_codepoints_view_utf8_length bytes
+ * @param in Codepoints (all of them at most U+10FFFF)
+ * @param count Number of codepoints
+ * @param out Output buffer
+ *
+ * On x86 blocks of eight ASCII codepoints are narrowed to bytes, and blocks of eight two byte codepoints are
+ * turned into byte pairs, with SSE2. Every other block is encoded one codepoint at a time.
+ * @internal
+ */
+void __fp_utf8_encode(const uint32_t* in, size_t count, char* out) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	size_t i = 0;
+#ifdef FP_SIMD_X86
+	const __m128i ascii_limit = _mm_set1_epi32(0x7F), two_byte_limit = _mm_set1_epi32(0x7FF);
+	const __m128i low_six = _mm_set1_epi32(0x3F), markers = _mm_set1_epi32(0x80C0), bias = _mm_set1_epi32(0x8000);
+	for(; i + 8 <= count; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(in + i)), b = _mm_loadu_si128((const __m128i*)(in + i + 4));
+		__m128i ab = _mm_or_si128(a, b);
+		if(_mm_movemask_epi8(_mm_cmpgt_epi32(ab, ascii_limit)) == 0) { // Eight ASCII bytes (lanes are < 0x80, saturation never kicks in)
+			__m128i words = _mm_packs_epi32(a, b);
+			_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(words, words));
+			out += 8;
+			continue;
+		}
+		__m128i too_small = _mm_or_si128(_mm_cmplt_epi32(a, _mm_set1_epi32(0x80)), _mm_cmplt_epi32(b, _mm_set1_epi32(0x80)));
+		if(_mm_movemask_epi8(_mm_or_si128(too_small, _mm_cmpgt_epi32(ab, two_byte_limit))) == 0) {
+			// Little endian pair: (0xC0 | c >> 6) then (0x80 | (c & 0x3F)), biased so the signed 32 -> 16 bit pack is exact
+			__m128i pair_a = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(a, 6), _mm_slli_epi32(_mm_and_si128(a, low_six), 8)), markers);
+			__m128i pair_b = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(b, 6), _mm_slli_epi32(_mm_and_si128(b, low_six), 8)), markers);
+			__m128i pairs = _mm_packs_epi32(_mm_sub_epi32(pair_a, bias), _mm_sub_epi32(pair_b, bias));
+			_mm_storeu_si128((__m128i*)out, _mm_add_epi16(pairs, _mm_set1_epi16((short)0x8000)));
+			out += 16;
+			continue;
+		}
+		for(size_t j = 0; j < 8; ++j)
+			out += fp_encode_utf8(in[i + j], out);
+	}
+#endif
+	for(; i < count; ++i)
+		out += fp_encode_utf8(in[i], out);
+}
+#else
+;
+#endif
+
 /**
  * @brief Convert codepoint view to UTF-8 string
  * @param codepoints View of UTF-32 codepoints
  * @return UTF-8 encoded string (must be freed), or nullptr on error
  *
+ * The exact length of the result is computed first, so the string is allocated once and encoded straight into.
+ *
  * @code
  * uint32_t codes[] = {0x48, 0x65, 0x6C, 0x6C, 0x6F};  // "Hello"
  * fp_view(uint32_t) view = fp_view_literal(uint32_t, codes, 5);
@@ -753,21 +976,14 @@ inline static size_t fp_encode_utf8(uint32_t codepoint, char out[4]) {
  * @endcode
  */
 inline static fp_string fp_codepoints_view_to_string(fp_view(uint32_t) codepoints) {
-	fp_string out = nullptr;
-	fpda_reserve(out, fp_view_size(codepoints));
-
-	for (size_t i = 0; i < fp_view_size(codepoints); ++i) {
-		char temp[4];
-		size_t len = fp_encode_utf8(*fp_view_access(uint32_t, codepoints, i), temp);
-		if(len == 0) {
-			if(out) fpda_free_and_null(out);
-			return nullptr;
-		}
-
-		for (size_t j = 0; j < len; ++j)
-			fp_string_append(out, temp[j]);
-	}
+	FP_ZONE_SCOPED;
+	size_t length = fp_codepoints_view_utf8_length(codepoints);
+	if(length == SIZE_MAX || length == 0) return nullptr;
 
+	fp_string out = nullptr;
+	fpda_resize(out, length);
+	__fp_utf8_encode(fp_view_data(uint32_t, codepoints), fp_view_size(codepoints), out);
+	out[length] = 0;
 	return out;
 }
 
@@ -792,6 +1008,262 @@ inline static fp_string fp_codepoints_to_string(const fp_dynarray(uint32_t) code
 	return fp_codepoints_view_to_string(fp_view_make_full(uint32_t, (uint32_t*)codepoints));
 }
 
+#ifndef FP_UTF8_REPLACEMENT_CHARACTER
+/// @brief Codepoint yielded by fp_string_view_next_codepoint for bytes which are not valid UTF-8
+#define FP_UTF8_REPLACEMENT_CHARACTER 0xFFFD
+#endif
+
+/**
+ * @brief Decode the codepoint at a byte offset and advance past it
+ * @param view UTF-8 encoded string view
+ * @param offset Byte offset of the codepoint, advanced to the next one
+ * @param codepoint Set to the decoded codepoint (FP_UTF8_REPLACEMENT_CHARACTER for an invalid byte, which is skipped alone)
+ * @return False once the end of the view is reached
+ *
+ * Walks a string one codepoint at a time without materializing them.
+ *
+ * @code
+ * size_t offset = 0;
+ * uint32_t codepoint;
+ * while(fp_string_view_next_codepoint(text, &offset, &codepoint))
+ *     printf("U+%04X\n", codepoint);
+ * @endcode
+ */
+inline static bool fp_string_view_next_codepoint(const fp_string_view view, size_t* offset, uint32_t* codepoint) FP_NOEXCEPT {
+	size_t n = fp_view_size(view);
+	if(*offset >= n) return false;
+	size_t length = __fp_utf8_decode_one(fp_view_data(uint8_t, view) + *offset, n - *offset, codepoint);
+	if(length == 0) {
+		*codepoint = FP_UTF8_REPLACEMENT_CHARACTER;
+		length = 1;
+	}
+	*offset += length;
+	return true;
+}
+
+/**
+ * @brief Get the byte offset of a codepoint
+ * @param view UTF-8 encoded string view
+ * @param index Index of the codepoint
+ * @return Byte offset of the codepoint (the size of the view for the index one past the last codepoint), or fp_not_found
+ *
+ * Skips whole vectors of bytes at a time by counting their lead bytes on x86. Use an fp_utf8_index for repeated lookups
+ * into the same long string.
+ */
+size_t fp_string_view_codepoint_offset(const fp_string_view view, size_t index) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	const uint8_t* s = fp_view_data(uint8_t, view);
+	size_t n = fp_view_size(view), i = 0, seen = 0;
+#ifdef FP_SIMD_X86
+	const __m128i continuation_limit = _mm_set1_epi8((char)0xBF);
+	for(; i + 16 <= n; i += 16) {
+		uint32_t lead = (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_loadu_si128((const __m128i*)(s + i)), continuation_limit));
+	#if defined(_MSC_VER) && !defined(__clang__)
+		size_t count = __popcnt(lead);
+	#else
+		size_t count = (size_t)__builtin_popcount(lead);
+	#endif
+		if(seen + count > index) break; // The codepoint starts in this block
+		seen += count;
+	}
+#endif
+	for(; i < n; ++i)
+		if((s[i] & 0xC0) != 0x80 && seen++ == index)
+			return i;
+	return seen == index ? n : fp_not_found;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Get the index of the codepoint containing a byte
+ * @param view UTF-8 encoded string view
+ * @param offset Byte offset (at most the size of the view)
+ * @return Index of the codepoint the byte belongs to
+ */
+inline static size_t fp_string_view_codepoint_index(const fp_string_view view, size_t offset) FP_NOEXCEPT {
+	assert(offset <= fp_view_size(view));
+	size_t index = fp_string_view_codepoint_count(fp_view_literal(char, fp_view_data(char, view), offset));
+	return offset < fp_view_size(view) && (fp_view_data(uint8_t, view)[offset] & 0xC0) == 0x80 && index ? index - 1 : index;
+}
+
+#ifndef FP_UTF8_INDEX_STRIDE
+/// @brief Default number of codepoints between the offsets an fp_utf8_index remembers
+#define FP_UTF8_INDEX_STRIDE 64
+#endif
+
+/**
+ * @brief Sparse index of the codepoints of a (valid) UTF-8 string, for random access by codepoint
+ *
+ * Remembers the byte offset of every stride-th codepoint, so a lookup walks at most stride - 1 codepoints
+ * while the index takes a fraction of the memory of a UTF-32 copy. Create with fp_utf8_index_create and
+ * destroy with fp_utf8_index_free.
+ */
+struct fp_utf8_index {
+	fp_dynarray(size_t) offsets; ///< Byte offset of codepoint i * stride
+	size_t stride;               ///< Number of codepoints between remembered offsets
+	size_t count;                ///< Number of codepoints in the string
+};
+
+/**
+ * @brief Index the codepoints of a string
+ * @param view UTF-8 encoded string view (the index is only valid for this string)
+ * @param stride Number of codepoints between remembered offsets (0 for FP_UTF8_INDEX_STRIDE)
+ * @return Index (must be freed with fp_utf8_index_free)
+ *
+ * @code
+ * struct fp_utf8_index index = fp_utf8_index_create(text, 0);
+ * size_t offset = fp_utf8_index_offset(&index, text, 123456); // Byte offset of the 123456th codepoint
+ * fp_utf8_index_free(&index);
+ * @endcode
+ */
+inline static struct fp_utf8_index fp_utf8_index_create(const fp_string_view view, size_t stride) FP_NOEXCEPT {
+	struct fp_utf8_index index;
+	const uint8_t* s = fp_view_data(uint8_t, view);
+	index.offsets = nullptr;
+	index.stride = stride ? stride : FP_UTF8_INDEX_STRIDE;
+	index.count = 0;
+	size_t until_next = 0;
+	for(size_t i = 0; i < fp_view_size(view); ++i) {
+		if((s[i] & 0xC0) == 0x80) continue;
+		if(until_next-- == 0) {
+			fpda_push_back(index.offsets, i);
+			until_next = index.stride - 1;
+		}
+		++index.count;
+	}
+	return index;
+}
+
+/**
+ * @brief Free the memory owned by an index
+ * @param index Index created by fp_utf8_index_create
+ */
+inline static void fp_utf8_index_free(struct fp_utf8_index* index) FP_NOEXCEPT {
+	fpda_free_and_null(index->offsets);
+	index->count = 0;
+}
+
+/**
+ * @brief Get the byte offset of a codepoint using an index
+ * @param index Index created by fp_utf8_index_create for view
+ * @param view String the index was created for
+ * @param codepoint Index of the codepoint
+ * @return Byte offset of the codepoint (the size of the view for the index one past the last codepoint), or fp_not_found
+ */
+inline static size_t fp_utf8_index_offset(const struct fp_utf8_index* index, const fp_string_view view, size_t codepoint) FP_NOEXCEPT {
+	if(codepoint > index->count) return fp_not_found;
+	if(codepoint == index->count) return fp_view_size(view);
+	const uint8_t* s = fp_view_data(uint8_t, view);
+	size_t i = index->offsets[codepoint / index->stride];
+	for(size_t remaining = codepoint % index->stride; remaining; --remaining)
+		while((s[++i] & 0xC0) == 0x80);
+	return i;
+}
+
+/**
+ * @brief Get the index of the codepoint containing a byte using an index
+ * @param index Index created by fp_utf8_index_create for view
+ * @param view String the index was created for
+ * @param offset Byte offset (at most the size of the view)
+ * @return Index of the codepoint the byte belongs to
+ */
+inline static size_t fp_utf8_index_codepoint(const struct fp_utf8_index* index, const fp_string_view view, size_t offset) FP_NOEXCEPT {
+	if(index->count == 0) return 0;
+	size_t low = 0, high = fpda_size(index->offsets); // Last remembered offset at or before the byte
+	while(high - low > 1) {
+		size_t middle = low + (high - low) / 2;
+		if(index->offsets[middle] <= offset) low = middle;
+		else high = middle;
+	}
+	size_t base = index->offsets[low];
+	fp_string_view rest = fp_view_literal(char, fp_view_data(char, view) + base, fp_view_size(view) - base);
+	return low * index->stride + fp_string_view_codepoint_index(rest, offset - base);
+}
+
+/**
+ * @brief Check if a codepoint extends the grapheme cluster before it
+ * @internal
+ *
+ * Covers the common combining marks, variation selectors, zero width (non) joiners, emoji skin tone modifiers and
+ * tag characters. This is an approximation of the Unicode grapheme rules (UAX #29) without the full property tables.
+ */
+inline static bool __fp_utf8_is_grapheme_extend(uint32_t c) FP_NOEXCEPT {
+	static const uint32_t ranges[][2] = {
+		{0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05C7}, {0x0610, 0x061A}, {0x064B, 0x065F}, {0x0670, 0x0670},
+		{0x06D6, 0x06ED}, {0x0900, 0x0903}, {0x093A, 0x094F}, {0x0951, 0x0957}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A},
+		{0x0E47, 0x0E4E}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200C, 0x200D}, {0x20D0, 0x20FF}, {0x302A, 0x302F},
+		{0x3099, 0x309A}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0x1F3FB, 0x1F3FF}, {0xE0020, 0xE007F}, {0xE0100, 0xE01EF},
+	};
+	if(c < 0x0300) return false;
+	for(size_t i = 0; i < sizeof(ranges) / sizeof(ranges[0]); ++i)
+		if(c >= ranges[i][0] && c <= ranges[i][1]) return true;
+	return false;
+}
+
+/**
+ * @brief Find the end of the grapheme cluster (user perceived character) starting at a byte offset
+ * @param view UTF-8 encoded string view
+ * @param offset Byte offset of the start of a grapheme cluster
+ * @return Byte offset of the start of the next grapheme cluster (the size of the view after the last one)
+ *
+ * Keeps "\r\n", base characters followed by combining marks, joiner (ZWJ) sequences, skin tone modifiers and flags
+ * (pairs of regional indicators) together. See __fp_utf8_is_grapheme_extend for the limits of the approximation.
+ */
+inline static size_t fp_string_view_next_grapheme(const fp_string_view view, size_t offset) FP_NOEXCEPT {
+	uint32_t c, next;
+	if(!fp_string_view_next_codepoint(view, &offset, &c)) return fp_view_size(view);
+	if(c == '\r') {
+		size_t after = offset;
+		if(fp_string_view_next_codepoint(view, &after, &next) && next == '\n') return after;
+		return offset;
+	}
+	bool regional = c >= 0x1F1E6 && c <= 0x1F1FF, joined = false;
+	for(size_t after = offset; fp_string_view_next_codepoint(view, &after, &next); offset = after) {
+		if(joined || __fp_utf8_is_grapheme_extend(next)) joined = next == 0x200D;
+		else if(regional && next >= 0x1F1E6 && next <= 0x1F1FF) regional = false;
+		else break;
+	}
+	return offset;
+}
+
+/**
+ * @brief Count the grapheme clusters (user perceived characters) of a string
+ * @param view UTF-8 encoded string view
+ * @return Number of grapheme clusters (see fp_string_view_next_grapheme)
+ */
+inline static size_t fp_string_view_grapheme_count(const fp_string_view view) FP_NOEXCEPT {
+	size_t count = 0;
+	for(size_t offset = 0; offset < fp_view_size(view); offset = fp_string_view_next_grapheme(view, offset))
+		++count;
+	return count;
+}
+
+/**
+ * @brief Get a subview which never splits a grapheme cluster
+ * @param view UTF-8 encoded string view
+ * @param start Index of the first grapheme cluster
+ * @param length Maximum number of grapheme clusters
+ * @return View of (at most) length grapheme clusters starting at start (empty if start is past the end)
+ *
+ * @code
+ * fp_string_view name = fp_string_view_from_literal("Zoe\xCC\x88 👩‍💻");
+ * fp_string_view first = fp_string_view_grapheme_subview(name, 2, 1); // "e" with its diaeresis
+ * fp_string_view last = fp_string_view_grapheme_subview(name, 4, 1);  // The whole woman technologist emoji
+ * @endcode
+ */
+inline static fp_string_view fp_string_view_grapheme_subview(const fp_string_view view, size_t start, size_t length) FP_NOEXCEPT {
+	size_t n = fp_view_size(view), begin = 0;
+	for(; start && begin < n; --start)
+		begin = fp_string_view_next_grapheme(view, begin);
+	size_t end = begin;
+	for(; length && end < n; --length)
+		end = fp_string_view_next_grapheme(view, end);
+	return fp_view_literal(char, fp_view_data(char, view) + begin, end - begin);
+}
+
 /**
  * @brief Replicate string in place
  * @param str Pointer to string
@@ -846,6 +1318,242 @@ inline static fp_string fp_string_replicate(const fp_string str, size_t times) F
 	return fp_string_view_replicate(fp_string_to_view_const(str), times);
 }
 
+#ifndef FP_STRING_SHORT_NEEDLE_SIZE
+/// @brief Longest needle searched for with the vectorized first/last byte filter, longer needles use Two-Way
+#define FP_STRING_SHORT_NEEDLE_SIZE 32
+#endif
+
+/**
+ * @brief Search forward through a haystack with memchr, checking each candidate position
+ * @param h Haystack
+ * @param n Length of the haystack
+ * @param needle Needle (at least one byte long)
+ * @param m Length of the needle
+ * @param start First position to check
+ * @return Position of the first match at or after start, or fp_not_found
+ * @internal
+ */
+inline static size_t __fp_string_search_memchr(const uint8_t* h, size_t n, const uint8_t* needle, size_t m, size_t start) FP_NOEXCEPT {
+	while(start + m <= n) {
+		const uint8_t* candidate = (const uint8_t*)memchr(h + start, needle[0], n - m + 1 - start);
+		if(!candidate) return fp_not_found;
+		start = (size_t)(candidate - h);
+		if(memcmp(candidate + 1, needle + 1, m - 1) == 0) return start;
+		++start;
+	}
+	return fp_not_found;
+}
+
+#if defined(FP_SIMD_X86) && defined(FP_IMPLEMENTATION)
+/// @cond INTERNAL
+// Generates a short needle search kernel: every window whose bytes at the offsets a and b both match the needle's sets a
+//	bit in the mask, only those windows get compared in full (see http://0x80.pl/articles/simd-strfind.html)
+#define __FP_DEFINE_SEARCH_KERNEL(name, attributes, vec_t, width, load, set1, equal, and_, movemask)\
+	attributes static size_t name(const uint8_t* h, size_t n, const uint8_t* needle, size_t m, size_t a, size_t b) FP_NOEXCEPT {\
+		const vec_t byte_a = set1((char)needle[a]), byte_b = set1((char)needle[b]);\
+		size_t i = 0;\
+		for(; i + m - 1 + (width) <= n; i += (width)) {\
+			vec_t block_a = load((const vec_t*)(h + i + a)), block_b = load((const vec_t*)(h + i + b));\
+			uint32_t mask = (uint32_t)movemask(and_(equal(block_a, byte_a), equal(block_b, byte_b)));\
+			for( ; mask; mask &= mask - 1) {\
+				size_t bit = __fp_lowest_bit(mask);\
+				if(memcmp(h + i + bit, needle, m) == 0) return i + bit;\
+			}\
+		}\
+		return __fp_string_search_memchr(h, n, needle, m, i);\
+	}
+
+__FP_DEFINE_SEARCH_KERNEL(__fp_string_search_sse2, , __m128i, 16, _mm_loadu_si128, _mm_set1_epi8, _mm_cmpeq_epi8, _mm_and_si128, _mm_movemask_epi8)
+#ifdef FP_SIMD_AVX2_DISPATCH
+__FP_DEFINE_SEARCH_KERNEL(__fp_string_search_avx2, __FP_AVX2_TARGET, __m256i, 32, _mm256_loadu_si256, _mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_and_si256, _mm256_movemask_epi8)
+#endif
+/// @endcond
+#endif // FP_SIMD_X86 && FP_IMPLEMENTATION
+
+/**
+ * @brief Search for a short needle, only comparing the windows whose bytes at two offsets match the needle's
+ * @param h Haystack
+ * @param n Length of the haystack
+ * @param needle Needle (at least two bytes long)
+ * @param m Length of the needle
+ * @param a Offset of the first byte to filter windows with
+ * @param b Offset of the second byte to filter windows with
+ * @return Position of the first match, or fp_not_found
+ *
+ * Compares a whole vector of windows at once on x86 (AVX2 when the CPU supports it, SSE2 otherwise),
+ * other platforms (or FP_DISABLE_SIMD) jump between occurrences of the needle's first byte with memchr.
+ * @internal
+ */
+size_t __fp_string_search_short(const uint8_t* h, size_t n, const uint8_t* needle, size_t m, size_t a, size_t b) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+#ifdef FP_SIMD_X86
+	typedef size_t(*kernel_t)(const uint8_t* h, size_t n, const uint8_t* needle, size_t m, size_t a, size_t b);
+	#ifdef FP_SIMD_AVX2_DISPATCH
+	const kernel_t kernel = __fp_simd_avx2() ? __fp_string_search_avx2 : __fp_string_search_sse2;
+	#else
+	const kernel_t kernel = __fp_string_search_sse2;
+	#endif
+	return kernel(h, n, needle, m, a, b);
+#else
+	(void)a; (void)b;
+	return __fp_string_search_memchr(h, n, needle, m, 0);
+#endif
+}
+#else
+;
+#endif
+
+/**
+ * @brief Critical factorization of a needle, everything the Two-Way algorithm needs to know about it
+ * @internal
+ */
+struct __FatTwoWayNeedle {
+	size_t suffix;  ///< Start of the right half of the needle
+	size_t period;  ///< Shift after a mismatch in the left half
+	bool periodic;  ///< Whether the left half repeats in the right half (the search then has to remember what it matched)
+};
+
+/**
+ * @brief Compute the critical factorization of a needle
+ * @param needle Needle (at least one byte long)
+ * @param m Length of the needle
+ * @return Factorization to pass to __fp_two_way_search
+ * @internal
+ */
+struct __FatTwoWayNeedle __fp_two_way_prepare(const uint8_t* needle, size_t m) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	// Maximal suffix under both the normal and the reversed byte order, the later starting of the two is critical
+	size_t suffixes[2], periods[2];
+	for(int reversed = 0; reversed < 2; ++reversed) {
+		size_t max_suffix = SIZE_MAX, j = 0, k = 1, p = 1;
+		while(j + k < m) {
+			uint8_t a = needle[j + k], b = needle[max_suffix + k];
+			if(reversed ? b < a : a < b) {
+				j += k;
+				k = 1;
+				p = j - max_suffix;
+			} else if(a == b) {
+				if(k != p) ++k;
+				else {
+					j += p;
+					k = 1;
+				}
+			} else {
+				max_suffix = j++;
+				k = p = 1;
+			}
+		}
+		suffixes[reversed] = max_suffix + 1;
+		periods[reversed] = p;
+	}
+	int critical = suffixes[1] < suffixes[0] ? 0 : 1;
+
+	struct __FatTwoWayNeedle out;
+	out.suffix = suffixes[critical];
+	out.period = periods[critical];
+	out.periodic = out.period + out.suffix <= m && memcmp(needle, needle + out.period, out.suffix) == 0;
+	if(!out.periodic) // The halves are distinct, any mismatch in the left half can skip past it
+		out.period = FP_MAX(out.suffix, m - out.suffix) + 1;
+	return out;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Two-Way search (Crochemore and Perrin), linear time in the worst case and constant space
+ * @param factorization Result of __fp_two_way_prepare for the needle
+ * @param shift Distance from the last occurrence of each byte in the needle to its end (NULL if not precomputed)
+ * @param h Haystack
+ * @param n Length of the haystack
+ * @param needle Needle (at least one byte long)
+ * @param m Length of the needle
+ * @return Position of the first match, or fp_not_found
+ *
+ * With a shift table, windows whose last byte doesn't match are skipped Horspool style. Without one,
+ * windows whose byte at the start of the right half doesn't match are skipped over with memchr.
+ * @internal
+ */
+size_t __fp_two_way_search(const struct __FatTwoWayNeedle* factorization, const size_t* shift, const uint8_t* h, size_t n, const uint8_t* needle, size_t m) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	const size_t suffix = factorization->suffix, period = factorization->period;
+	size_t j = 0, memory = 0;
+	while(j + m <= n) {
+		if(shift) {
+			size_t skip = shift[h[j + m - 1]];
+			if(skip) {
+				// The last period is out of place, nothing can match before the mismatch
+				if(factorization->periodic && memory && skip < period) skip = m - period;
+				memory = 0;
+				j += skip;
+				continue;
+			}
+		} else if(memory == 0 && h[j + suffix] != needle[suffix]) {
+			const uint8_t* next = (const uint8_t*)memchr(h + j + suffix + 1, needle[suffix], n - m - j);
+			if(!next) return fp_not_found;
+			j = (size_t)(next - h) - suffix;
+		}
+
+		// Match the right half...
+		size_t i = FP_MAX(suffix, memory);
+		while(i < m && needle[i] == h[i + j]) ++i;
+		if(i < m) {
+			j += i - suffix + 1;
+			memory = 0;
+			continue;
+		}
+
+		// ... then the left half (down to what a previous period already matched)
+		size_t lower = factorization->periodic ? memory : 0;
+		i = suffix;
+		while(i > lower && needle[i - 1] == h[i - 1 + j]) --i;
+		if(i <= lower) return j;
+
+		j += period;
+		if(factorization->periodic) memory = m - period;
+	}
+	return fp_not_found;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Find the first occurrence of a byte string in another
+ * @param haystack Bytes to search
+ * @param n Length of the haystack
+ * @param needle Bytes to find
+ * @param m Length of the needle
+ * @return Offset of the first match, or fp_not_found
+ *
+ * Picks the algorithm from the needle's length: memchr for single bytes, a vectorized first/last byte filter
+ * for needles up to FP_STRING_SHORT_NEEDLE_SIZE bytes, and Two-Way (linear in the worst case) beyond that.
+ * @internal
+ */
+size_t __fp_string_search(const char* haystack, size_t n, const char* needle, size_t m) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	const uint8_t* h = (const uint8_t*)haystack, *nd = (const uint8_t*)needle;
+	if(m == 0) return 0;
+	if(m > n) return fp_not_found;
+	if(m == 1) {
+		const uint8_t* found = (const uint8_t*)memchr(h, nd[0], n);
+		return found ? (size_t)(found - h) : fp_not_found;
+	}
+
+	if(m <= FP_STRING_SHORT_NEEDLE_SIZE)
+		return __fp_string_search_short(h, n, nd, m, 0, m - 1);
+
+	struct __FatTwoWayNeedle factorization = __fp_two_way_prepare(nd, m);
+	return __fp_two_way_search(&factorization, NULL, h, n, nd, m);
+}
+#else
+;
+#endif
+
 /**
  * @brief Find substring in string view
  * @param haystack String to search in
@@ -853,6 +1561,9 @@ inline static fp_string fp_string_replicate(const fp_string str, size_t times) F
  * @param start Starting position for search
  * @return Index of first occurrence, or fp_not_found if not found
  *
+ * Short needles are found with a vectorized first/last byte filter and long ones with the Two-Way algorithm,
+ * which is linear in the worst case (see __fp_string_search).
+ *
  * @code
  * fp_string_view text = fp_string_view_from_literal("The quick brown fox");
  * fp_string_view search = fp_string_view_from_literal("brown");
@@ -864,22 +1575,11 @@ inline static fp_string fp_string_replicate(const fp_string str, size_t times) F
  * @endcode
  */
 inline static size_t fp_string_view_find(const fp_string_view haystack, const fp_string_view needle, size_t start) {
+	FP_ZONE_SCOPED_AGGRO;
 	size_t haystack_size = fp_view_size(haystack);
-	size_t needle_size = fp_view_size(needle);
 	assert(start <= haystack_size);
-	if(needle_size > haystack_size - start) return fp_not_found; // Can't find a needle thats bigger than the haystack
-
-	for(size_t i = start, bound = haystack_size - needle_size; i <= bound; ++i) {
-		bool continue_outer = false;
-		for(size_t j = 0; j < needle_size; ++j)
-			if(*fp_view_access(char, haystack, i + j) != *fp_view_access(char, needle, j)) {
-				continue_outer = true;
-				break;
-			}
-		if(continue_outer) continue;
-		return i;
-	}
-	return fp_not_found;
+	size_t found = __fp_string_search(fp_view_data(char, haystack) + start, haystack_size - start, fp_view_data(char, needle), fp_view_size(needle));
+	return found == fp_not_found ? found : found + start;
 }
 
 /**
@@ -932,6 +1632,146 @@ inline static bool fp_string_contains(const fp_string haystack, const fp_string
 	return fp_string_find(haystack, needle, start) != fp_not_found;
 }
 
+/**
+ * @brief Needle preprocessed once so that it can be searched for in many haystacks
+ *
+ * Create with fp_string_searcher_create. The searcher only references the needle, which must outlive it.
+ * Needles up to FP_STRING_SHORT_NEEDLE_SIZE bytes filter candidate windows by their two rarest bytes, which
+ * rules out far more windows than the first and last bytes fp_string_view_find has to use. Longer needles
+ * keep their Two-Way factorization and a shift table for the last byte of each window.
+ */
+struct fp_string_searcher {
+	fp_string_view needle;             ///< The needle (not owned)
+	size_t rare[2];                    ///< Offsets of the two rarest bytes of a short needle
+	struct __FatTwoWayNeedle two_way;  ///< Critical factorization of a long needle
+	size_t shift[256];                 ///< Distance from the last occurrence of each byte in a long needle to its end
+};
+
+/**
+ * @brief Rough rank of how common a byte is in text and logs (higher is more common)
+ * @internal
+ */
+inline static uint8_t __fp_byte_frequency_rank(uint8_t c) FP_NOEXCEPT {
+	if(c == ' ') return 255;
+	if(c >= 'a' && c <= 'z') return strchr("etaoinsrhl", c) ? 200 : 150;
+	if(c != '\0' && strchr("\n,.-/:=_", c)) return 130;
+	if(c >= '0' && c <= '9') return 120;
+	if(c >= 'A' && c <= 'Z') return 90;
+	if(c > ' ' && c < 127) return 50;
+	return 10;
+}
+
+/**
+ * @brief Preprocess a needle for repeated searches
+ * @param needle String to search for (must outlive the searcher)
+ * @return Searcher to pass to fp_string_searcher_find, fp_string_searcher_find_all and fp_string_searcher_count
+ *
+ * @code
+ * struct fp_string_searcher error = fp_string_searcher_create(fp_string_view_from_literal("ERROR"));
+ * for(each line)
+ *     if(fp_string_searcher_find(&error, line, 0) != fp_not_found)
+ *         report(line);
+ * @endcode
+ */
+inline static struct fp_string_searcher fp_string_searcher_create(const fp_string_view needle) FP_NOEXCEPT {
+	struct fp_string_searcher out;
+	memset(&out, 0, sizeof(out));
+	out.needle = needle;
+	const uint8_t* n = fp_view_data(uint8_t, needle);
+	size_t m = fp_view_size(needle);
+	if(m < 2) return out;
+
+	if(m <= FP_STRING_SHORT_NEEDLE_SIZE) {
+		out.rare[0] = 0;
+		out.rare[1] = m - 1;
+		for(size_t i = 0; i < m; ++i)
+			if(__fp_byte_frequency_rank(n[i]) < __fp_byte_frequency_rank(n[out.rare[0]]))
+				out.rare[0] = i;
+		out.rare[1] = out.rare[0] == 0 ? m - 1 : 0;
+		for(size_t i = 0; i < m; ++i)
+			if(i != out.rare[0] && __fp_byte_frequency_rank(n[i]) < __fp_byte_frequency_rank(n[out.rare[1]]))
+				out.rare[1] = i;
+		return out;
+	}
+
+	out.two_way = __fp_two_way_prepare(n, m);
+	for(size_t i = 0; i < 256; ++i)
+		out.shift[i] = m;
+	for(size_t i = 0; i < m; ++i)
+		out.shift[n[i]] = m - i - 1;
+	return out;
+}
+
+/**
+ * @brief Find the first occurrence of a searcher's needle
+ * @param searcher Searcher created by fp_string_searcher_create
+ * @param haystack String to search in
+ * @param start Starting position
+ * @return Index of the first occurrence, or fp_not_found if not found
+ */
+inline static size_t fp_string_searcher_find(const struct fp_string_searcher* searcher, const fp_string_view haystack, size_t start) FP_NOEXCEPT {
+	FP_ZONE_SCOPED_AGGRO;
+	size_t n = fp_view_size(haystack), m = fp_view_size(searcher->needle);
+	assert(start <= n);
+	const uint8_t* h = fp_view_data(uint8_t, haystack) + start, *needle = fp_view_data(uint8_t, searcher->needle);
+	n -= start;
+
+	size_t found;
+	if(m < 2 || m > n) found = __fp_string_search((const char*)h, n, (const char*)needle, m);
+	else if(m <= FP_STRING_SHORT_NEEDLE_SIZE) found = __fp_string_search_short(h, n, needle, m, searcher->rare[0], searcher->rare[1]);
+	else found = __fp_two_way_search(&searcher->two_way, searcher->shift, h, n, needle, m);
+	return found == fp_not_found ? found : found + start;
+}
+
+/**
+ * @brief Append the start of every (non overlapping) occurrence of a searcher's needle to a dynamic array
+ * @param searcher Searcher created by fp_string_searcher_create
+ * @param haystack String to search in
+ * @param out Dynamic array to append to (reusing it across haystacks avoids reallocating, may point to NULL)
+ * @return The dynamic array (also stored in *out)
+ *
+ * @code
+ * fp_dynarray(size_t) hits = NULL;
+ * for(each line) {
+ *     fpda_clear(hits);
+ *     fp_string_searcher_find_all_inplace(&token, line, &hits);
+ *     // ...
+ * }
+ * fpda_free_and_null(hits);
+ * @endcode
+ */
+inline static fp_dynarray(size_t) fp_string_searcher_find_all_inplace(const struct fp_string_searcher* searcher, const fp_string_view haystack, fp_dynarray(size_t)* out) FP_NOEXCEPT {
+	FP_ZONE_SCOPED;
+	size_t step = FP_MAX(fp_view_size(searcher->needle), (size_t)1);
+	for(size_t found = 0; found <= fp_view_size(haystack) && (found = fp_string_searcher_find(searcher, haystack, found)) != fp_not_found; found += step)
+		fpda_push_back(*out, found);
+	return *out;
+}
+
+/**
+ * @brief Find the start of every (non overlapping) occurrence of a searcher's needle
+ * @param searcher Searcher created by fp_string_searcher_create
+ * @param haystack String to search in
+ * @return New dynamic array of positions (NULL if there were none, must be freed)
+ */
+inline static fp_dynarray(size_t) fp_string_searcher_find_all(const struct fp_string_searcher* searcher, const fp_string_view haystack) FP_NOEXCEPT {
+	fp_dynarray(size_t) out = NULL;
+	return fp_string_searcher_find_all_inplace(searcher, haystack, &out);
+}
+
+/**
+ * @brief Count the (non overlapping) occurrences of a searcher's needle
+ * @param searcher Searcher created by fp_string_searcher_create
+ * @param haystack String to search in
+ * @return Number of occurrences
+ */
+inline static size_t fp_string_searcher_count(const struct fp_string_searcher* searcher, const fp_string_view haystack) FP_NOEXCEPT {
+	size_t count = 0, step = FP_MAX(fp_view_size(searcher->needle), (size_t)1);
+	for(size_t found = 0; found <= fp_view_size(haystack) && (found = fp_string_searcher_find(searcher, haystack, found)) != fp_not_found; found += step)
+		++count;
+	return count;
+}
+
 /**
  * @brief Check if string view starts with prefix
  * @param haystack String to check
@@ -1007,12 +1847,256 @@ inline static size_t fp_string_ends_with(const fp_string haystack, const fp_stri
 	return fp_string_view_ends_with(fp_string_to_view_const(haystack), fp_string_to_view_const(needle), end);
 }
 
+/// @brief Largest byte set which is matched with vector compares (larger sets use the bitmap a byte at a time)
+/// @note Not configurable, the vector kernels compare against exactly this many members
+#define FP_BYTE_SET_VECTOR_SIZE 4
+
+/**
+ * @brief Set of bytes (e.g. delimiters), classifying a byte is a single bit test
+ *
+ * Create with fp_byte_set_create. Small sets additionally remember their members so that
+ * fp_byte_set_find can compare a whole vector of bytes against them at once.
+ */
+struct fp_byte_set {
+	uint64_t bits[4];                          ///< One bit per byte value
+	uint8_t members[FP_BYTE_SET_VECTOR_SIZE];  ///< Members of the set (padded by repeating the first) if it has at most FP_BYTE_SET_VECTOR_SIZE of them
+	size_t count;                              ///< Number of distinct members
+};
+
+/**
+ * @brief Create a set from the bytes of a string
+ * @param bytes Bytes in the set (duplicates are ignored)
+ * @return Byte set
+ *
+ * @code
+ * struct fp_byte_set whitespace = fp_byte_set_create(fp_string_view_from_literal(" \t\r\n"));
+ * assert(fp_byte_set_contains(&whitespace, '\t'));
+ * @endcode
+ */
+inline static struct fp_byte_set fp_byte_set_create(const fp_string_view bytes) FP_NOEXCEPT {
+	struct fp_byte_set set;
+	memset(&set, 0, sizeof(set));
+	for(size_t i = 0; i < fp_view_size(bytes); ++i) {
+		uint8_t byte = fp_view_data(uint8_t, bytes)[i];
+		if(set.bits[byte >> 6] & ((uint64_t)1 << (byte & 63))) continue;
+		set.bits[byte >> 6] |= (uint64_t)1 << (byte & 63);
+		if(set.count < FP_BYTE_SET_VECTOR_SIZE) set.members[set.count] = byte;
+		++set.count;
+	}
+	for(size_t i = set.count; i > 0 && i < FP_BYTE_SET_VECTOR_SIZE; ++i)
+		set.members[i] = set.members[0];
+	return set;
+}
+
+/**
+ * @brief Check if a byte is in a set
+ * @param set Byte set created by fp_byte_set_create
+ * @param byte Byte to check
+ * @return True if the byte is in the set
+ */
+inline static bool fp_byte_set_contains(const struct fp_byte_set* set, uint8_t byte) FP_NOEXCEPT {
+	return (set->bits[byte >> 6] >> (byte & 63)) & 1;
+}
+
+#if defined(FP_SIMD_X86) && defined(FP_IMPLEMENTATION)
+/// @cond INTERNAL
+// Generates a byte set kernel: each step compares a whole vector of bytes against every member of a small set,
+//	the lowest bit of the combined mask is the first byte in the set
+#define __FP_DEFINE_BYTE_SET_KERNEL(name, attributes, vec_t, width, load, set1, equal, or_, movemask)\
+	attributes static size_t name(const struct fp_byte_set* set, const uint8_t* h, size_t n, size_t i) FP_NOEXCEPT {\
+		const vec_t m0 = set1((char)set->members[0]), m1 = set1((char)set->members[1]);\
+		const vec_t m2 = set1((char)set->members[2]), m3 = set1((char)set->members[3]);\
+		for(; i + (width) <= n; i += (width)) {\
+			vec_t block = load((const vec_t*)(h + i));\
+			uint32_t mask = (uint32_t)movemask(or_(or_(equal(block, m0), equal(block, m1)), or_(equal(block, m2), equal(block, m3))));\
+			if(mask) return i + __fp_lowest_bit(mask);\
+		}\
+		for(; i < n; ++i)\
+			if(fp_byte_set_contains(set, h[i])) return i;\
+		return fp_not_found;\
+	}
+
+__FP_DEFINE_BYTE_SET_KERNEL(__fp_byte_set_find_sse2, , __m128i, 16, _mm_loadu_si128, _mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128, _mm_movemask_epi8)
+#ifdef FP_SIMD_AVX2_DISPATCH
+__FP_DEFINE_BYTE_SET_KERNEL(__fp_byte_set_find_avx2, __FP_AVX2_TARGET, __m256i, 32, _mm256_loadu_si256, _mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_or_si256, _mm256_movemask_epi8)
+#endif
+/// @endcond
+#endif // FP_SIMD_X86 && FP_IMPLEMENTATION
+
+/**
+ * @brief Find the first byte of a string which is in a set
+ * @param set Byte set created by fp_byte_set_create
+ * @param haystack String to search
+ * @param start Offset to start searching from
+ * @return Position of the first byte in the set, or fp_not_found
+ *
+ * Sets of at most FP_BYTE_SET_VECTOR_SIZE bytes are matched a whole vector at a time on x86 (AVX2 when the CPU
+ * supports it, SSE2 otherwise), larger sets (other platforms, or FP_DISABLE_SIMD) test the bitmap byte by byte.
+ *
+ * @code
+ * struct fp_byte_set separators = fp_byte_set_create(fp_string_view_from_literal(",\n"));
+ * size_t end_of_field = fp_byte_set_find(&separators, line, 0);
+ * @endcode
+ */
+size_t fp_byte_set_find(const struct fp_byte_set* set, const fp_string_view haystack, size_t start) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	FP_ZONE_SCOPED_AGGRO;
+	const uint8_t* h = fp_view_data(uint8_t, haystack);
+	size_t n = fp_view_size(haystack);
+	if(start >= n || set->count == 0) return fp_not_found;
+	if(set->count == 1) {
+		const uint8_t* found = (const uint8_t*)memchr(h + start, set->members[0], n - start);
+		return found ? (size_t)(found - h) : fp_not_found;
+	}
+
+#ifdef FP_SIMD_X86
+	typedef size_t(*kernel_t)(const struct fp_byte_set* set, const uint8_t* h, size_t n, size_t i);
+	#ifdef FP_SIMD_AVX2_DISPATCH
+	const kernel_t kernel = __fp_simd_avx2() ? __fp_byte_set_find_avx2 : __fp_byte_set_find_sse2;
+	#else
+	const kernel_t kernel = __fp_byte_set_find_sse2;
+	#endif
+	if(set->count <= FP_BYTE_SET_VECTOR_SIZE)
+		return kernel(set, h, n, start);
+#endif
+
+	for(size_t i = start; i < n; ++i)
+		if(fp_byte_set_contains(set, h[i])) return i;
+	return fp_not_found;
+}
+#else
+;
+#endif
+
+#if defined(FP_SIMD_X86) && defined(FP_IMPLEMENTATION)
+/// @cond INTERNAL
+// Generates a block mask kernel: classifies 64 bytes against every member of a small set, a vector at a time
+#define __FP_DEFINE_BYTE_SET_MASK_KERNEL(name, attributes, vec_t, width, load, set1, equal, or_, movemask)\
+	attributes static uint64_t name(const struct fp_byte_set* set, const uint8_t* block) FP_NOEXCEPT {\
+		const vec_t m0 = set1((char)set->members[0]), m1 = set1((char)set->members[1]);\
+		const vec_t m2 = set1((char)set->members[2]), m3 = set1((char)set->members[3]);\
+		uint64_t mask = 0;\
+		for(size_t i = 0; i < 64; i += (width)) {\
+			vec_t bytes = load((const vec_t*)(block + i));\
+			uint64_t bits = (uint32_t)movemask(or_(or_(equal(bytes, m0), equal(bytes, m1)), or_(equal(bytes, m2), equal(bytes, m3))));\
+			mask |= bits << i;\
+		}\
+		return mask;\
+	}
+
+__FP_DEFINE_BYTE_SET_MASK_KERNEL(__fp_byte_set_mask64_sse2, , __m128i, 16, _mm_loadu_si128, _mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128, _mm_movemask_epi8)
+#ifdef FP_SIMD_AVX2_DISPATCH
+__FP_DEFINE_BYTE_SET_MASK_KERNEL(__fp_byte_set_mask64_avx2, __FP_AVX2_TARGET, __m256i, 32, _mm256_loadu_si256, _mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_or_si256, _mm256_movemask_epi8)
+#endif
+/// @endcond
+#endif // FP_SIMD_X86 && FP_IMPLEMENTATION
+
+/**
+ * @brief Classify a block of 64 bytes at once
+ * @param set Byte set created by fp_byte_set_create
+ * @param block 64 readable bytes
+ * @return Mask with bit i set if block[i] is in the set
+ *
+ * This is the building block of structural scanners (see fp_csv_parser): the positions of every delimiter in
+ * a block are found with a few vector compares, and are then consumed by clearing the mask's lowest bit.
+ * Sets of at most FP_BYTE_SET_VECTOR_SIZE bytes use SSE2/AVX2 on x86, others test the bitmap byte by byte.
+ */
+uint64_t fp_byte_set_mask64(const struct fp_byte_set* set, const uint8_t* block) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+#ifdef FP_SIMD_X86
+	typedef uint64_t(*kernel_t)(const struct fp_byte_set* set, const uint8_t* block);
+	#ifdef FP_SIMD_AVX2_DISPATCH
+	const kernel_t kernel = __fp_simd_avx2() ? __fp_byte_set_mask64_avx2 : __fp_byte_set_mask64_sse2;
+	#else
+	const kernel_t kernel = __fp_byte_set_mask64_sse2;
+	#endif
+	if(set->count > 0 && set->count <= FP_BYTE_SET_VECTOR_SIZE)
+		return kernel(set, block);
+#endif
+
+	uint64_t mask = 0;
+	for(size_t i = 0; i < 64; ++i)
+		mask |= (uint64_t)fp_byte_set_contains(set, block[i]) << i;
+	return mask;
+}
+#else
+;
+#endif
+
+/**
+ * @brief State of a lazy split, yields one piece at a time without allocating
+ *
+ * Create with fp_string_view_split_lazy (or fp_string_split_lazy) and advance with fp_string_split_next.
+ * The pieces reference the split string, which must outlive them.
+ */
+struct fp_string_split_iterator {
+	fp_string_view rest;             ///< Part of the string which has not been yielded yet
+	struct fp_byte_set delimiters;   ///< Bytes separating the pieces
+	bool finished;                   ///< Whether the last piece has been yielded
+};
+
+/**
+ * @brief Start splitting a string view by delimiters, lazily
+ * @param view String to split
+ * @param delimiters String containing delimiter characters
+ * @return Iterator to pass to fp_string_split_next
+ *
+ * Yields exactly the pieces fp_string_view_split would return (including empty ones between adjacent delimiters).
+ *
+ * @code
+ * struct fp_string_split_iterator fields = fp_string_view_split_lazy(line, fp_string_view_from_literal("\t"));
+ * fp_string_view field;
+ * while(fp_string_split_next(&fields, &field))
+ *     printf("[%.*s]\n", (int)fp_string_view_length(field), fp_view_data(char, field));
+ * @endcode
+ */
+inline static struct fp_string_split_iterator fp_string_view_split_lazy(const fp_string_view view, const fp_string_view delimiters) FP_NOEXCEPT {
+	struct fp_string_split_iterator it;
+	it.rest = view;
+	it.delimiters = fp_byte_set_create(delimiters);
+	it.finished = false;
+	return it;
+}
+
+/**
+ * @brief Start splitting a string by delimiters, lazily
+ * @param str String to split
+ * @param delimiters Delimiter characters
+ * @return Iterator to pass to fp_string_split_next
+ */
+inline static struct fp_string_split_iterator fp_string_split_lazy(const fp_string str, const fp_string delimiters) FP_NOEXCEPT {
+	return fp_string_view_split_lazy(fp_string_to_view_const(str), fp_string_to_view_const(delimiters));
+}
+
+/**
+ * @brief Get the next piece of a lazy split
+ * @param it Iterator created by fp_string_view_split_lazy
+ * @param piece Set to the next piece
+ * @return False once every piece has been yielded (piece is then left untouched)
+ */
+inline static bool fp_string_split_next(struct fp_string_split_iterator* it, fp_string_view* piece) FP_NOEXCEPT {
+	if(it->finished) return false;
+	size_t end = fp_byte_set_find(&it->delimiters, it->rest, 0);
+	if(end == fp_not_found) {
+		*piece = it->rest;
+		it->finished = true;
+		return true;
+	}
+	*piece = fp_view_literal(char, fp_view_data(char, it->rest), end);
+	it->rest = fp_view_literal(char, fp_view_data(char, it->rest) + end + 1, fp_view_size(it->rest) - end - 1);
+	return true;
+}
+
 /**
  * @brief Split string view by delimiters
  * @param view String to split
  * @param delimiters String containing delimiter characters
  * @return Array of string views (must be freed)
  *
+ * @see fp_string_view_split_lazy to walk the pieces without allocating
+ *
  * @code
  * fp_string_view csv = fp_string_view_from_literal("apple,banana,cherry");
  * fp_dynarray(fp_string_view) parts = fp_string_view_split(csv,
@@ -1027,29 +2111,15 @@ inline static size_t fp_string_ends_with(const fp_string haystack, const fp_stri
  * fpda_free(parts);
  * @endcode
  */
- inline static fp_dynarray(fp_string_view) fp_string_view_split(const fp_string_view view, const fp_string_view delimiters) {
-     fp_dynarray(fp_string_view) out = nullptr;
-     const char* data = fp_view_data(char, view);
-     const size_t len = fp_view_size(view);
-     size_t start = 0;
-
-     for(size_t i = 0; i <= len; ++i) {
-         bool is_delim = (i == len);
-         if(!is_delim)
-             for(size_t d = 0; d < fp_view_size(delimiters); ++d)
-                 if(data[i] == fp_view_data(char, delimiters)[d]) {
-                     is_delim = true;
-                     break;
-                 }
-
-         if(is_delim) {
-             fpda_push_back(out, fp_view_literal(char, data + start, i - start));
-             start = i + 1;
-         }
-     }
-
-     return out;
- }
+inline static fp_dynarray(fp_string_view) fp_string_view_split(const fp_string_view view, const fp_string_view delimiters) {
+	FP_ZONE_SCOPED;
+	fp_dynarray(fp_string_view) out = nullptr;
+	struct fp_string_split_iterator it = fp_string_view_split_lazy(view, delimiters);
+	fp_string_view piece;
+	while(fp_string_split_next(&it, &piece))
+		fpda_push_back(out, piece);
+	return out;
+}
 
 /**
  * @brief Split string by delimiters
@@ -1091,6 +2161,7 @@ inline static fp_dynarray(fp_string_view) fp_string_split(const fp_string view,
  * @endcode
  */
 inline static fp_string fp_string_replace_range_inplace(fp_string* in, const fp_string_view with, size_t start, size_t range_len) {
+	FP_ZONE_SCOPED_AGGRO;
 	assert(is_fpda(*in));
 	auto end = start + range_len;
 	auto in_len = fp_string_length(*in);
@@ -1169,6 +2240,7 @@ inline static fp_string fp_string_replace_range(const fp_string str, const fp_st
  * @endcode
  */
 inline static size_t fp_string_replace_first_inplace(fp_string* in, const fp_string_view find, const fp_string_view replace, size_t start) {
+	FP_ZONE_SCOPED_AGGRO;
 	start = fp_string_view_find(fp_string_to_view_const(*in), find, start);
 	if(start == fp_not_found) return start;
 
@@ -1219,7 +2291,9 @@ inline static size_t fp_string_replace_first(const fp_string str, const fp_strin
  * @param start Starting position
  * @return Modified string
  *
- * Replaces all occurrences of find with replace, starting from start position.
+ * Replaces all (non overlapping) occurrences of find with replace, starting from start position. Every match
+ * is rewritten in a single pass: a replacement no longer than find compacts the string in place, a longer one
+ * first counts the matches and grows the string exactly once. An empty find leaves the string untouched.
  *
  * @code
  * fp_string text = fp_string_format("foo bar foo baz foo");
@@ -1232,8 +2306,39 @@ inline static size_t fp_string_replace_first(const fp_string str, const fp_strin
  * @endcode
  */
 inline static fp_string fp_string_replace_inplace(fp_string* in, const fp_string_view find, const fp_string_view replace, size_t start) {
-	while((start = fp_string_replace_first_inplace(in, find, replace, start)) != fp_not_found)
-		start += fp_view_size(replace);
+	FP_ZONE_SCOPED;
+	if(*in == NULL) return NULL; // Nothing to replace in an empty string
+	assert(is_fpda(*in));
+	size_t n = fp_string_length(*in), m = fp_view_size(find), r = fp_view_size(replace);
+	if(m == 0 || start > n) return *in;
+	struct fp_string_searcher searcher = fp_string_searcher_create(find);
+
+	// A longer replacement needs the final size up front: grow once, move the text to the end and rewrite it front to back
+	//	(the write position never overtakes the read position, they meet after the last match)
+	size_t read = start, write = start, found;
+	if(r > m) {
+		size_t count = 0;
+		for(found = start; (found = fp_string_searcher_find(&searcher, fp_string_view_literal(*in, n), found)) != fp_not_found; found += m)
+			++count;
+		if(count == 0) return *in;
+		size_t grown = n + count * (r - m);
+		fpda_grow_to_size(*in, grown);
+		memmove(*in + start + (grown - n), *in + start, n - start);
+		read = start + (grown - n);
+		n = grown;
+	}
+
+	while((found = fp_string_searcher_find(&searcher, fp_string_view_literal(*in, n), read)) != fp_not_found) {
+		memmove(*in + write, *in + read, found - read);
+		write += found - read;
+		memcpy(*in + write, fp_view_data(char, replace), r);
+		write += r;
+		read = found + m;
+	}
+	memmove(*in + write, *in + read, n - read);
+	write += n - read;
+	if(write < n) fpda_pop_back_to_size(*in, write);
+	(*in)[write] = 0; // Make sure the string is null terminated
 	return *in;
 }
 
@@ -1245,6 +2350,8 @@ inline static fp_string fp_string_replace_inplace(fp_string* in, const fp_string
  * @param start Starting position
  * @return New string with all replacements
  *
+ * The matches are counted first, so the result is allocated exactly once at its final size.
+ *
  * @code
  * fp_string_view template = fp_string_view_from_literal("Hello {name}, welcome {name}!");
  * fp_string personalized = fp_string_view_replace(template,
@@ -1256,8 +2363,30 @@ inline static fp_string fp_string_replace_inplace(fp_string* in, const fp_string
  * @endcode
  */
 inline static fp_string fp_string_view_replace(const fp_string_view view, const fp_string_view find, const fp_string_view replace, size_t start) {
-	auto out = fp_string_view_make_dynamic(view);
-	return fp_string_replace_inplace(&out, find, replace, start);
+	FP_ZONE_SCOPED;
+	const char* in = fp_view_data(char, view);
+	size_t n = fp_view_size(view), m = fp_view_size(find), r = fp_view_size(replace);
+	if(m == 0 || start > n) return fp_string_view_make_dynamic(view);
+	struct fp_string_searcher searcher = fp_string_searcher_create(find);
+
+	size_t count = 0, found;
+	for(found = start; (found = fp_string_searcher_find(&searcher, view, found)) != fp_not_found; found += m)
+		++count;
+	if(count == 0) return fp_string_view_make_dynamic(view);
+
+	size_t size = n - count * m + count * r, read = 0, write = 0;
+	fp_string out = nullptr;
+	fpda_resize(out, size); // Even when everything is replaced by nothing the result is an (empty) string
+	for(found = start; (found = fp_string_searcher_find(&searcher, view, found)) != fp_not_found; found += m) {
+		memcpy(out + write, in + read, found - read);
+		write += found - read;
+		memcpy(out + write, fp_view_data(char, replace), r);
+		write += r;
+		read = found + m;
+	}
+	memcpy(out + write, in + read, n - read);
+	out[size] = 0;
+	return out;
 }
 
 /**
@@ -1282,6 +2411,97 @@ inline static fp_string fp_string_replace(const fp_string str, const fp_string f
 	return fp_string_view_replace(fp_string_to_view_const(str), fp_string_to_view_const(find), fp_string_to_view_const(replace), start);
 }
 
+/**
+ * @brief Size of the stack buffer formatting functions try before allocating
+ *
+ * Output shorter than this (and than the spare capacity of the destination) is formatted in a single pass.
+ *
+ * @code
+ * #define FP_STRING_FORMAT_STACK_SIZE 1024
+ * #include <fp/string.h>
+ * @endcode
+ */
+#ifndef FP_STRING_FORMAT_STACK_SIZE
+#define FP_STRING_FORMAT_STACK_SIZE 256
+#endif
+
+/**
+ * @brief Append printf-style formatted text to a string (variadic version)
+ * @param dest Pointer to the string to append to (may point to NULL, a new string is then created)
+ * @param format Format string
+ * @param args Variable argument list
+ * @return The destination string (also stored in *dest)
+ *
+ * The text is formatted straight into the spare capacity of the destination (or a stack buffer if that
+ * is larger), formatting a second time only if the output doesn't fit. Nothing is appended if the format fails.
+ *
+ * @code
+ * fp_string log = NULL;
+ * for(size_t i = 0; i < count; ++i)
+ *     fp_string_format_append(log, "%zu: %s\n", i, names[i]); // No reallocation once the capacity settles
+ * fp_string_free_and_null(log);
+ * @endcode
+ */
+fp_string fp_string_vformat_append(fp_string* dest, const char* format, va_list args) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	FP_ZONE_SCOPED;
+	va_list retry;
+	va_copy(retry, args);
+	size_t size = *dest ? fpda_size(*dest) : 0;
+	size_t spare = *dest ? fpda_capacity(*dest) - size + 1 : 0; // Dynamic arrays always have room for a terminator past their capacity
+
+	char stack[FP_STRING_FORMAT_STACK_SIZE];
+	bool in_place = spare >= sizeof(stack);
+	char* buffer = in_place ? *dest + size : stack;
+	size_t available = in_place ? spare : sizeof(stack);
+	int result = vsnprintf(buffer, available, format, args);
+	if(result <= 0) {
+		if(*dest) (*dest)[size] = 0;
+		va_end(retry);
+		return *dest;
+	}
+
+	size_t written = result;
+	if(*dest == NULL) fpda_grow_to_size(*dest, written);
+	else fpda_grow(*dest, written); // Doesn't reallocate if the output was formatted in place
+	if(written < available) {
+		if(!in_place) memcpy(*dest + size, stack, written + 1);
+	} else vsnprintf(*dest + size, written + 1, format, retry);
+	va_end(retry);
+	return *dest;
+}
+#else
+;
+#endif
+
+/**
+ * @brief Internal function to append formatted text
+ * @internal
+ */
+inline static fp_string fp_string_format_append_impl(fp_string* dest, const char* format, ...) FP_NOEXCEPT {
+	va_list args;
+	va_start(args, format);
+	fp_string out = fp_string_vformat_append(dest, format, args);
+	va_end(args);
+	return out;
+}
+
+/**
+ * @brief Append printf-style formatted text to a string
+ * @param str String to modify (may be NULL, a new string is then created)
+ * @param ... Format string followed by its arguments
+ *
+ * @code
+ * fp_string str = fp_string_format("Total");
+ * fp_string_format_append(str, ": %d items", 3);
+ *
+ * printf("%s\n", str);  // "Total: 3 items"
+ * fp_string_free_and_null(str);
+ * @endcode
+ */
+#define fp_string_format_append(str, ...) fp_string_format_append_impl(&(str), __VA_ARGS__)
+
 /**
  * @brief Format string with printf-style formatting (variadic version)
  * @param format Format string
@@ -1298,15 +2518,12 @@ inline static fp_string fp_string_replace(const fp_string str, const fp_string f
  * @endcode
  */
 inline static fp_string fp_string_vformat(const fp_string format, va_list args) FP_NOEXCEPT {
-	va_list argsSize;
-	va_copy(argsSize, args);
-	size_t size = vsnprintf(NULL, 0, format, argsSize);
-	va_end(argsSize);
-
-	fp_dynarray(char) out = NULL;
-	fpda_resize(out, size);
-
-	vsnprintf(out, fpda_size(out) + 1, format, args);
+	fp_string out = NULL;
+	fp_string_vformat_append(&out, format, args);
+	if(out == NULL) { // Appending nothing doesn't allocate, but formatting always returns a string
+		fpda_resize(out, 0);
+		out[0] = 0;
+	}
 	return out;
 }
 
@@ -1316,9 +2533,26 @@ inline static fp_string fp_string_vformat(const fp_string format, va_list args)
  * @param args Variable argument list
  * @return Formatted string
  */
-inline static fp_string fp_string_view_vformat(const fp_string_view format, va_list args) FP_NOEXCEPT {
-	return fp_string_vformat(fp_string_view_make_dynamic(format), args);
+fp_string fp_string_view_vformat(const fp_string_view format, va_list args) FP_NOEXCEPT
+#ifdef FP_IMPLEMENTATION
+{
+	// vsnprintf needs a null terminated format, short ones are copied to the stack
+	char stack[FP_STRING_FORMAT_STACK_SIZE];
+	size_t size = fp_view_size(format);
+	if(size < sizeof(stack)) {
+		memcpy(stack, fp_view_data(char, format), size);
+		stack[size] = 0;
+		return fp_string_vformat(stack, args);
+	}
+
+	fp_string terminated = fp_string_view_make_dynamic(format);
+	fp_string out = fp_string_vformat(terminated, args);
+	fp_string_free(terminated);
+	return out;
 }
+#else
+;
+#endif
 
 /**
  * @brief Format string with printf-style formatting
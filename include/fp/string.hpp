@@ -4,6 +4,7 @@
 #include "fp/pointer.hpp"
 #include "string.h"
 #include <compare>
+#include <iterator>
 
 #ifdef FP_OSTREAM_SUPPORT
 	#include <ostream>
@@ -80,6 +81,14 @@ namespace fp {
 		bool ends_with(const string_view needle, size_t end = 0) const { return fp_string_view_ends_with(view_(), needle, end); }
 
 		inline fp::dynarray<string_view> split(const string_view delimiters) const { return {(string_view*)fp_string_view_split(view_(), delimiters)}; }
+		struct split_range split_lazy(const string_view delimiters) const;
+
+		inline size_t codepoint_count() const { return fp_string_view_codepoint_count(view_()); }
+		inline size_t codepoint_offset(size_t index) const { return fp_string_view_codepoint_offset(view_(), index); }
+		inline size_t codepoint_index(size_t offset) const { return fp_string_view_codepoint_index(view_(), offset); }
+		struct codepoint_range codepoints() const;
+		inline size_t grapheme_count() const { return fp_string_view_grapheme_count(view_()); }
+		inline string_view grapheme_subview(size_t start, size_t length) const { return {fp_string_view_grapheme_subview(view_(), start, length)}; }
 
 #ifdef FP_OSTREAM_SUPPORT
 		string_view(std::string_view v) : super((char*)v.data(), v.size()) {}
@@ -95,6 +104,119 @@ namespace fp {
 #endif
 	};
 
+	/**
+	 * @brief Range over the pieces of a lazily split string (see fp_string_view_split_lazy)
+	 *
+	 * Nothing is allocated, each piece is found as the range is iterated.
+	 *
+	 * @code{.cpp}
+	 * for(fp::string_view field: line.split_lazy("\t"))
+	 *     process(field);
+	 * @endcode
+	 */
+	struct split_range {
+		fp_string_split_iterator raw;
+
+		struct iterator {
+			using iterator_category = std::input_iterator_tag;
+			using value_type = string_view;
+			using difference_type = std::ptrdiff_t;
+
+			fp_string_split_iterator state;
+			fp_string_view current = {};
+			bool done = false;
+
+			inline string_view operator*() const { return current; }
+			inline iterator& operator++() { done = !fp_string_split_next(&state, &current); return *this; }
+			inline void operator++(int) { ++*this; }
+			inline bool operator==(std::default_sentinel_t) const { return done; }
+		};
+
+		inline iterator begin() const { return ++iterator{raw}; }
+		inline std::default_sentinel_t end() const { return {}; }
+	};
+	inline split_range string_view::split_lazy(const string_view delimiters) const { return {fp_string_view_split_lazy(view_(), delimiters)}; }
+
+	/**
+	 * @brief Range over the codepoints of a UTF-8 string, decoded as it is iterated (see fp_string_view_next_codepoint)
+	 *
+	 * @code{.cpp}
+	 * for(uint32_t codepoint: text.codepoints())
+	 *     histogram[codepoint]++;
+	 * @endcode
+	 */
+	struct codepoint_range {
+		fp_string_view raw;
+
+		struct iterator {
+			using iterator_category = std::input_iterator_tag;
+			using value_type = uint32_t;
+			using difference_type = std::ptrdiff_t;
+
+			fp_string_view view;
+			size_t next = 0;
+			uint32_t current = 0;
+			bool done = false;
+
+			inline uint32_t operator*() const { return current; }
+			inline iterator& operator++() { done = !fp_string_view_next_codepoint(view, &next, &current); return *this; }
+			inline void operator++(int) { ++*this; }
+			inline bool operator==(std::default_sentinel_t) const { return done; }
+		};
+
+		inline iterator begin() const { return ++iterator{raw}; }
+		inline std::default_sentinel_t end() const { return {}; }
+	};
+	inline codepoint_range string_view::codepoints() const { return {view_()}; }
+
+	/**
+	 * @brief Owning sparse index of the codepoints of a string (see fp_utf8_index)
+	 *
+	 * The indexed string must outlive the index.
+	 */
+	struct utf8_index {
+		fp_utf8_index raw;
+		string_view indexed;
+
+		utf8_index(const string_view text, size_t stride = 0) noexcept : raw(fp_utf8_index_create(text, stride)), indexed(text) {}
+		utf8_index(const utf8_index&) = delete;
+		utf8_index(utf8_index&& o) noexcept : raw(std::exchange(o.raw, {})), indexed(o.indexed) {}
+		utf8_index& operator=(const utf8_index&) = delete;
+		utf8_index& operator=(utf8_index&& o) noexcept { std::swap(raw, o.raw); std::swap(indexed, o.indexed); return *this; }
+		~utf8_index() noexcept { fp_utf8_index_free(&raw); }
+
+		inline size_t size() const noexcept { return raw.count; }
+		inline size_t offset(size_t codepoint) const noexcept { return fp_utf8_index_offset(&raw, indexed, codepoint); }
+		inline size_t codepoint(size_t offset) const noexcept { return fp_utf8_index_codepoint(&raw, indexed, offset); }
+	};
+
+	/**
+	 * @brief Output iterator appending characters to a fat pointer string (see std::back_insert_iterator)
+	 *
+	 * Growth is amortized and the string may start out as nullptr.
+	 * @note The string isn't null terminated while characters are being appended, call terminate once done.
+	 */
+	struct string_back_insert_iterator {
+		using iterator_category = std::output_iterator_tag;
+		using value_type = void;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = void;
+
+		fp_string* target;
+
+		inline string_back_insert_iterator& operator=(char c) {
+			if(*target == nullptr) fpda_reserve(*target, FPDA_DEFAULT_SIZE_BYTES);
+			fpda_push_back(*target, c);
+			return *this;
+		}
+		inline string_back_insert_iterator& operator*() { return *this; }
+		inline string_back_insert_iterator& operator++() { return *this; }
+		inline string_back_insert_iterator operator++(int) { return *this; }
+
+		inline void terminate() const { if(*target) (*target)[fpda_size(*target)] = 0; }
+	};
+
 	template<typename Derived, typename Dynamic>
 	struct string_crtp_common {
 		using view = string_view;
@@ -152,6 +274,7 @@ namespace fp {
 		fp::dynarray<const string_view> split(const string_view delimiters) const { return {(const string_view*)fp_string_view_split(full_view(), delimiters)}; }
 		fp::dynarray<string_view> split(const char* delimiters) { return {(string_view*)fp_string_split(ptr(), delimiters)}; }
 		fp::dynarray<const string_view> split(const char* delimiters) const { return {(const string_view*)fp_string_split(ptr(), delimiters)}; }
+		split_range split_lazy(const string_view delimiters) const { return full_view().split_lazy(delimiters); }
 
 		Dynamic replace_range(const string_view with, size_t start, size_t len) const {
 			return Dynamic{fp_string_view_replace_range(full_view(), with, start, len)};
@@ -232,11 +355,19 @@ namespace fp {
 		}
 	#endif
 
+		template<class... Args>
+		Derived& format_append(std::format_string<Args...> fmt, Args&&... args) {
+			string_back_insert_iterator out{&ptr()};
+			std::format_to(out, fmt, std::forward<Args>(args)...);
+			out.terminate();
+			return *derived();
+		}
+
 		template<class... Args>
 		static Derived format(std::format_string<Args...> fmt, Args&&... args) {
-			auto standard = std::format(fmt, std::forward<Args>(args)...);
-			if(standard.empty()) return nullptr;
-			return Derived{fp_string_make_dynamic(standard.c_str())};
+			Derived out = nullptr;
+			out.format_append(fmt, std::forward<Args>(args)...);
+			return out;
 		}
 #elif !defined(_MSC_VER)
 		Derived format(...) const {
@@ -350,6 +481,32 @@ namespace fp {
 		return string{fp_string_view_replace(view_(), find, replace, start)};
 	}
 
+	/**
+	 * @brief Needle preprocessed once so that it can be searched for in many haystacks (see fp_string_searcher)
+	 *
+	 * The searcher only references the needle, which must outlive it.
+	 *
+	 * @code{.cpp}
+	 * fp::string_searcher token("user_id=");
+	 * for(fp::string_view line: lines)
+	 *     total += token.count(line);
+	 * @endcode
+	 */
+	struct string_searcher {
+		fp_string_searcher raw;
+
+		string_searcher(const string_view needle) : raw(fp_string_searcher_create(needle)) {}
+
+		inline size_t find(const string_view haystack, size_t start = 0) const { return fp_string_searcher_find(&raw, haystack, start); }
+		inline bool contains(const string_view haystack, size_t start = 0) const { return find(haystack, start) != fp_not_found; }
+		inline dynarray<size_t> find_all(const string_view haystack) const { return fp_string_searcher_find_all(&raw, haystack); }
+		inline dynarray<size_t>& find_all(const string_view haystack, dynarray<size_t>& out) const {
+			fp_string_searcher_find_all_inplace(&raw, haystack, &out.raw);
+			return out;
+		}
+		inline size_t count(const string_view haystack) const { return fp_string_searcher_count(&raw, haystack); }
+	};
+
 	inline string operator+(const string_view a, const string& b) {
 		return a.make_dynamic().concatenate_inplace(b.full_view());
 	}
@@ -378,8 +535,7 @@ namespace fp {
 			template<typename T>
 			requires(requires{std::formatter<T, char>{};})
 			inline string& operator<<(T value) {
-				fp::auto_free str = format("{}", value);
-				concatenate_inplace(str);
+				format_append("{}", value);
 				return *this;
 			}
 
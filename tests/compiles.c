@@ -3,6 +3,11 @@
 #include <fp/dynarray.h>
 #include <fp/string.h>
 #include <fp/hash.h>
+#include <fp/arena.h>
+#include <fp/pool.h>
+#include <fp/mmap.h>
+#include <fp/aho_corasick.h>
+#include <fp/csv.h>
 
 // void* __heap_end;
 
@@ -31,6 +36,49 @@ void check_heap(void) {
 	fp_free(arr);
 }
 
+static size_t live_allocations = 0;
+static void* check_allocate(void* state, size_t size) {
+	++*(size_t*)state;
+	return malloc(size);
+}
+static void check_deallocate(void* state, void* p, size_t size) {
+	(void)size;
+	--*(size_t*)state;
+	free(p);
+}
+
+void check_allocator(void) {
+	struct fp_allocator allocator = {check_allocate, NULL, check_deallocate, &live_allocations};
+
+	int* arr = fp_malloc_with_allocator(int, 20, &allocator);
+	assert_with_side_effects(fp_get_allocator(arr) == &allocator);
+	assert_with_side_effects(live_allocations == 1);
+	arr = fp_realloc(int, arr, 25);
+	arr[20] = 6;
+	assert_with_side_effects(fp_length(arr) == 25);
+	assert_with_side_effects(arr[20] == 6);
+	assert_with_side_effects(live_allocations == 1);
+	fp_free(arr);
+	assert_with_side_effects(live_allocations == 0);
+
+	fp_dynarray(int) da = fpda_malloc_with_allocator(int, 1, &allocator);
+	for(int i = 0; i < 20; i++)
+		fpda_push_back(da, i);
+	assert_with_side_effects(fpda_get_allocator(da) == &allocator);
+	assert_with_side_effects(da[19] == 19);
+	assert_with_side_effects(live_allocations == 1);
+	fpda_free(da);
+	assert_with_side_effects(live_allocations == 0);
+
+	da = fpda_malloc_aligned_with_allocator(int, 1, 64, &allocator);
+	for(int i = 0; i < 20; i++)
+		fpda_push_back(da, i);
+	assert_with_side_effects(((uintptr_t)da) % 64 == 0);
+	assert_with_side_effects(da[19] == 19);
+	fpda_free(da);
+	assert_with_side_effects(live_allocations == 0);
+}
+
 void check_view(void) {
 	int* arr = fp_alloca(int, 20);
 	arr[10] = 6;
@@ -185,7 +233,7 @@ void check_hashtable(void) {
 	assert(*v == key);
 
 	auto p = fpht_find_position(table, key);
-	assert(p == 6);
+	assert(p == 2);
 	assert(table[p] == key);
 	v = fpht_find(table, key);
 	assert(*v == key);
@@ -10,10 +10,23 @@
 #include <fp/dynarray.h>
 #include <fp/string.h>
 #include <fp/hash.h>
+#include <fp/arena.h>
+#include <fp/pool.h>
+#include <fp/mmap.h>
+#include <fp/aho_corasick.h>
+#include <fp/csv.h>
+
+#include <string>
+#include <unordered_set>
+
+#ifdef FP_ENABLE_BENCHMARKING
+#include <nanobench.h>
+#endif
 
 extern "C" {
 void check_stack();
 void check_heap();
+void check_allocator();
 void check_view();
 void check_dynarray();
 void check_string();
@@ -23,6 +36,36 @@ void check_hashtable();
 
 #define DISCARD_RESULT (void)
 
+struct counting_allocator_state {
+	size_t allocations = 0, reallocations = 0, frees = 0;
+};
+static void* counting_allocate(void* state, size_t size) noexcept {
+	++((counting_allocator_state*)state)->allocations;
+	return malloc(size);
+}
+static void* counting_reallocate(void* state, void* p, size_t /*old_size*/, size_t new_size) noexcept {
+	++((counting_allocator_state*)state)->reallocations;
+	return realloc(p, new_size);
+}
+static void counting_deallocate(void* state, void* p, size_t /*size*/) noexcept {
+	++((counting_allocator_state*)state)->frees;
+	free(p);
+}
+
+// Deterministic inputs for the randomized tests (a linear congruential generator, keeping its better high bits)
+struct test_random {
+	uint32_t seed;
+	uint32_t operator()() { seed = seed * 1664525 + 1013904223; return seed >> 16; }
+	// String of size bytes, each picked among the alphabet bytes starting at first
+	std::string string(size_t size, char first = 'a', size_t alphabet = 26) {
+		std::string out(size, first);
+		for(auto& c: out) c = first + (*this)() % alphabet;
+		return out;
+	}
+};
+
+static fp_string_view view(const std::string& s) { return fp_string_view_literal((char*)s.data(), s.size()); }
+
 TEST_SUITE("LibFP") {
 
 	TEST_CASE("Stack") {
@@ -52,6 +95,311 @@ TEST_SUITE("LibFP") {
 		fp_free(arr);
 	}
 
+	TEST_CASE("Allocator") {
+		counting_allocator_state state;
+		fp_allocator counting = {counting_allocate, counting_reallocate, counting_deallocate, &state};
+
+		int* arr = fp_malloc_with_allocator(int, 20, &counting);
+		CHECK(fp_is_heap_allocated(arr));
+		CHECK(fp_length(arr) == 20);
+		CHECK(fp_get_allocator(arr) == &counting);
+		arr = fp_realloc(int, arr, 40);
+		CHECK(fp_length(arr) == 40);
+		CHECK(state.allocations == 1);
+		CHECK(state.reallocations == 1);
+		fp_free(arr);
+		CHECK(state.frees == 1);
+
+		fp_dynarray(int) da = fpda_malloc_with_allocator(int, 2, &counting);
+		CHECK(fpda_size(da) == 0);
+		CHECK(fpda_capacity(da) == 2);
+		CHECK(fpda_get_allocator(da) == &counting);
+		for(int i = 0; i < 100; i++)
+			fpda_push_back(da, i);
+		CHECK(fpda_get_allocator(da) == &counting);
+		CHECK(da[99] == 99);
+		fpda_shrink_to_fit(da);
+		CHECK(fpda_get_allocator(da) == &counting);
+		fpda_free_and_null(da);
+		CHECK(state.allocations + state.reallocations > 2);
+		CHECK(state.allocations == state.frees);
+
+		fp_dynarray(int) plain = nullptr;
+		fpda_push_back(plain, 5);
+		CHECK(fpda_get_allocator(plain) == nullptr);
+		fpda_free_and_null(plain);
+
+		auto config = fpht_default_config();
+		config.allocator = &counting;
+		int* table = fp_create_hash_table(int, config);
+		CHECK(fpht_get_allocator(table) == &counting);
+		for(int i = 0; i < 50; i++)
+			fpht_insert(table, i);
+		CHECK(fpht_get_allocator(table) == &counting);
+		CHECK(fpda_get_allocator(__fpht_header(table)->entry_infos) == &counting);
+		fpht_free_and_null(table);
+		CHECK(state.allocations == state.frees);
+	}
+
+	TEST_CASE("Arena") {
+		fp_arena* arena = fp_arena_create(0);
+		auto allocator = fp_arena_allocator(arena);
+
+		int* arr = fp_malloc_with_allocator(int, 20, allocator);
+		CHECK(fp_get_allocator(arr) == allocator);
+		CHECK(fp_length(arr) == 20);
+		fp_free(arr); // Most recent allocation is given back
+		CHECK(fp_arena_used(arena) == 0);
+
+		fp_dynarray(int) da = fpda_malloc_with_allocator(int, 1, allocator);
+		int* first = da;
+		for(int i = 0; i < 1000; i++)
+			fpda_push_back(da, i);
+		CHECK(da == first); // Grew in place
+		CHECK(fpda_size(da) == 1000);
+		CHECK(da[999] == 999);
+
+		auto previous = fp_set_thread_allocator(allocator);
+		fp_string text = fp_string_format("%s:%s:%s", "one", "two", "three");
+		fp_dynarray(fp_string_view) parts = fp_string_split(text, ":");
+		fp_dynarray(int) implicit = nullptr;
+		fpda_push_back(implicit, 5);
+		CHECK(fp_set_thread_allocator(previous) == allocator);
+		CHECK(fpda_get_allocator(text) == allocator);
+		CHECK(fpda_get_allocator(parts) == allocator);
+		CHECK(fpda_get_allocator(implicit) == allocator);
+		CHECK(fpda_size(parts) == 3);
+		CHECK(fp_string_view_equal(parts[2], fp_string_view_from_literal("three")));
+		CHECK(da[999] == 999);
+
+		// Allocations larger than a block get their own
+		fp_dynarray(uint8_t) big = fpda_malloc_with_allocator(uint8_t, 2 * FP_ARENA_DEFAULT_BLOCK_SIZE, allocator);
+		fpda_grow_to_size_and_initialize(big, 2 * FP_ARENA_DEFAULT_BLOCK_SIZE, 7);
+		CHECK(big[2 * FP_ARENA_DEFAULT_BLOCK_SIZE - 1] == 7);
+
+		fp_arena_reset(arena);
+		CHECK(fp_arena_used(arena) == 0);
+		da = fpda_malloc_with_allocator(int, 1, allocator);
+		fpda_push_back(da, 6);
+		CHECK(*da == 6);
+		fp_arena_release_and_null(arena);
+		CHECK(arena == nullptr);
+	}
+
+	TEST_CASE("Pool") {
+		fp_pool* pool = fp_pool_create();
+		auto allocator = fp_pool_allocator(pool);
+
+		fp_dynarray(int) a = fpda_malloc_with_allocator(int, 4, allocator);
+		fpda_push_back(a, 1);
+		int* first = a;
+		fpda_free_and_null(a);
+		fp_dynarray(int) b = fpda_malloc_with_allocator(int, 4, allocator);
+		CHECK(b == first); // Reused from the free list
+		for(int i = 0; i < 1000; i++) // Grows past the largest size class onto the heap
+			fpda_push_back(b, i);
+		CHECK(fpda_get_allocator(b) == allocator);
+		CHECK(b[999] == 999);
+		fpda_shrink_delete_range(b, 10, 990); // And back into the pool
+		CHECK(fpda_size(b) == 10);
+		CHECK(b[9] == 9);
+		fpda_free_and_null(b);
+
+		fp_dynarray(fp_string) strings = nullptr;
+		auto previous = fp_set_thread_allocator(fp_pool_thread_allocator());
+		for(int i = 0; i < 10000; i++)
+			fpda_push_back(strings, fp_string_format("%d", i));
+		fp_set_thread_allocator(previous);
+		CHECK(fpda_get_allocator(strings[9999]) == fp_pool_thread_allocator());
+		CHECK(fp_string_view_equal(fp_string_to_view(strings[9999]), fp_string_view_from_literal("9999")));
+		for(size_t i = 0; i < fpda_size(strings); i++)
+			fp_string_free(strings[i]);
+		fpda_free_and_null(strings);
+
+		fp_pool_release_thread();
+		fp_pool_release_and_null(pool);
+		CHECK(pool == nullptr);
+	}
+
+	TEST_CASE("Mmap") {
+		auto allocator = fp_mmap_allocator(true);
+		fp_dynarray(uint32_t) da = fpda_malloc_with_allocator(uint32_t, 1, allocator);
+		constexpr uint32_t count = 4 * FP_MMAP_THRESHOLD / sizeof(uint32_t); // Crosses the threshold then grows through mremap
+		for(uint32_t i = 0; i < count; i++)
+			fpda_push_back(da, i);
+		CHECK(fpda_get_allocator(da) == allocator);
+		CHECK(fpda_size(da) == count);
+		bool intact = true;
+		for(uint32_t i = 0; i < count; i++)
+			intact &= da[i] == i;
+		CHECK(intact);
+
+		fpda_shrink_delete_range(da, 100, count - 100); // Back under the threshold
+		CHECK(fpda_size(da) == 100);
+		CHECK(da[99] == 99);
+		fpda_free_and_null(da);
+
+		float* aligned = fp_malloc_aligned_with_allocator(float, FP_MMAP_THRESHOLD, 64, fp_mmap_allocator(false));
+		CHECK(((uintptr_t)aligned) % 64 == 0);
+		aligned[FP_MMAP_THRESHOLD - 1] = 5;
+		aligned = fp_realloc(float, aligned, 2 * FP_MMAP_THRESHOLD);
+		CHECK(aligned[FP_MMAP_THRESHOLD - 1] == 5);
+		fp_free_and_null(aligned);
+	}
+
+	TEST_CASE("Mapped File") {
+		const char* path = "fp_mapped_file.test";
+		FILE* file = fopen(path, "wb");
+		REQUIRE(file);
+		for(int i = 0; i < 1024; i++) fputs("abc", file); // 3072 bytes
+		fputs("needle", file);
+		for(int i = 0; i < 1018 / 2; i++) fputs("xy", file); // Pad out to exactly 4096 bytes
+		fclose(file);
+
+		char* data = fp_mmap_file(char, path);
+		REQUIRE(data);
+		CHECK(fp_is_mapped(data));
+		CHECK(!fp_is_heap_allocated(data));
+		CHECK(fp_length(data) == 4096);
+		CHECK(data[4096] == 0); // Null terminated even when the file fills its last page
+		CHECK(fp_string_view_find(fp_string_to_view(data), fp_string_view_from_literal("needle"), 0) == 3072);
+		auto view = fp_view_make_full(char, data);
+		CHECK(fp_view_size(view) == 4096);
+		fp_munmap_file_and_null(data);
+
+		uint32_t* words = fp_mmap_file(uint32_t, path);
+		CHECK(fp_length(words) == 1024);
+		fp_munmap_file_and_null(words);
+
+		CHECK(fp_mmap_file(char, "fp_mapped_file.missing") == nullptr);
+		remove(path);
+	}
+
+	TEST_CASE("Aligned") {
+		float* arr = fp_malloc_aligned(float, 10, 64);
+		CHECK(((uintptr_t)arr) % 64 == 0);
+		CHECK(fp_length(arr) == 10);
+		CHECK(fp_get_alignment(arr) == 64);
+		arr[9] = 9;
+		arr = fp_realloc(float, arr, 10000);
+		CHECK(((uintptr_t)arr) % 64 == 0);
+		CHECK(arr[9] == 9);
+		fp_free_and_null(arr);
+
+		fp_dynarray(double) da = fpda_malloc_aligned(double, 1, 32);
+		CHECK(fpda_get_alignment(da) == 32);
+		bool aligned = true;
+		for(int i = 0; i < 1000; i++) {
+			fpda_push_back(da, i);
+			aligned &= ((uintptr_t)da) % 32 == 0;
+		}
+		CHECK(aligned);
+		CHECK(da[999] == 999);
+		fpda_shrink_delete_range(da, 0, 500);
+		CHECK(((uintptr_t)da) % 32 == 0);
+		CHECK(da[0] == 500);
+		fp_dynarray(double) copy = fpda_clone(da);
+		CHECK(((uintptr_t)copy) % 32 == 0);
+		CHECK(fpda_get_alignment(copy) == 32);
+		CHECK(copy[499] == 999);
+		fpda_free_and_null(copy);
+		fpda_free_and_null(da);
+
+		// Blocks which move to an address with a different misalignment shift their contents
+		fp_arena* arena = fp_arena_create(0);
+		fp_dynarray(uint32_t) moved = fpda_malloc_aligned_with_allocator(uint32_t, 1, 256, fp_arena_allocator(arena));
+		for(uint32_t i = 0; i < 1000; i++) {
+			fpda_push_back(moved, i);
+			DISCARD_RESULT fp_malloc_with_allocator(uint8_t, i % 7 + 1, fp_arena_allocator(arena)); // Force the next growth to move
+			aligned &= ((uintptr_t)moved) % 256 == 0;
+		}
+		CHECK(aligned);
+		bool intact = true;
+		for(uint32_t i = 0; i < 1000; i++)
+			intact &= moved[i] == i;
+		CHECK(intact);
+		CHECK(fpda_size(moved) == 1000);
+		fp_arena_release_and_null(arena);
+	}
+
+	template<typename T>
+	bool check_find(T miss, T hit) {
+		bool ok = true;
+		for(size_t length : {1, 7, 15, 16, 17, 31, 32, 33, 64, 100}) {
+			T* data = fp_malloc(T, length);
+			for(size_t i = 0; i < length; ++i) data[i] = miss;
+			ok &= fp_find(data, hit) == fp_not_found && fp_rfind(data, hit) == fp_not_found && !fp_contains(data, hit);
+			for(size_t i = 0; i < length; ++i) { // A hit in every lane, in the vector body and in the scalar tail
+				data[i] = hit;
+				ok &= fp_find(data, hit) == i && fp_rfind(data, hit) == i && fp_contains(data, hit);
+				data[i] = miss;
+			}
+			if(length > 2) {
+				data[1] = data[length - 2] = hit;
+				ok &= fp_find(data, hit) == 1 && fp_rfind(data, hit) == length - 2;
+			}
+			fp_free_and_null(data);
+		}
+		return ok;
+	}
+
+	TEST_CASE("Find") {
+		struct Wide { uint64_t a, b; };
+		struct Odd { uint8_t bytes[3]; };
+		CHECK(check_find<uint8_t>(1, 2));
+		CHECK(check_find<uint16_t>(0x0101, 0x0102));
+		CHECK(check_find<uint32_t>(0x01010101, 0x01010102));
+		CHECK(check_find<uint64_t>(0x0101010101010101, 0x0101010201010101)); // Only the high half differs
+		CHECK(check_find<Wide>({1, 1}, {1, 2}));
+		CHECK(check_find<Odd>({{1, 1, 1}}, {{1, 1, 2}}));
+
+		uint32_t* none = nullptr, needle = 5;
+		CHECK(fp_find(none, needle) == fp_not_found);
+		CHECK(fp_rfind(none, needle) == fp_not_found);
+	}
+
+#ifdef FP_ENABLE_ALLOCATION_STATS
+	TEST_CASE("Allocation Stats") {
+		auto heap = fp_allocation_stats_thread(FP_HEAP_MAGIC_NUMBER);
+		auto arrays = fp_allocation_stats_thread(FP_DYNARRAY_MAGIC_NUMBER);
+		auto tables = fp_allocation_stats_thread(FP_HASH_TABLE_MAGIC_NUMBER);
+
+		int* p = fp_malloc(int, 10);
+		CHECK(fp_allocation_stats_thread(FP_HEAP_MAGIC_NUMBER).allocations == heap.allocations + 1);
+		CHECK(fp_allocation_stats_thread(FP_HEAP_MAGIC_NUMBER).bytes_live > heap.bytes_live);
+		fp_free_and_null(p);
+		auto heapAfter = fp_allocation_stats_thread(FP_HEAP_MAGIC_NUMBER);
+		CHECK(heapAfter.frees == heap.frees + 1);
+		CHECK(heapAfter.bytes_live == heap.bytes_live);
+		CHECK(heapAfter.peak_bytes >= heap.bytes_live);
+
+		fp_dynarray(int) da = nullptr;
+		for(int i = 0; i < 1000; i++)
+			fpda_push_back(da, i);
+		auto arraysGrown = fp_allocation_stats_thread(FP_DYNARRAY_MAGIC_NUMBER);
+		CHECK(arraysGrown.allocations == arrays.allocations + 1);
+		CHECK(arraysGrown.growths > arrays.growths);
+		CHECK(arraysGrown.reallocations >= arraysGrown.growths - arrays.growths);
+		CHECK(arraysGrown.growth_histogram[12] == arrays.growth_histogram[12] + 1); // 1024 ints == 2^12 bytes
+		fpda_free_and_null(da);
+		CHECK(fp_allocation_stats_thread(FP_DYNARRAY_MAGIC_NUMBER).bytes_live == arrays.bytes_live);
+
+		fp_hashtable(int) table = fp_create_default_hash_table(int);
+		int key = 5;
+		fpht_insert(table, key);
+		fpht_double_size_and_rehash(table);
+		auto tablesGrown = fp_allocation_stats_thread(FP_HASH_TABLE_MAGIC_NUMBER);
+		CHECK(tablesGrown.allocations == tables.allocations + 1);
+		CHECK(tablesGrown.rehashes == tables.rehashes + 1);
+		fpht_free_and_null(table);
+		CHECK(fp_allocation_stats_thread(FP_HASH_TABLE_MAGIC_NUMBER).bytes_live == tables.bytes_live);
+
+		auto total = fp_allocation_stats_total(FP_HASH_TABLE_MAGIC_NUMBER);
+		CHECK(total.rehashes >= tablesGrown.rehashes);
+		CHECK(fp_allocation_stats_total(FP_STACK_MAGIC_NUMBER).allocations == 0);
+	}
+#endif
+
 	TEST_CASE("View") {
 		int* arr = fp_alloca(int, 20);
 		arr[10] = 6;
@@ -332,6 +680,15 @@ TEST_SUITE("LibFP") {
 		CHECK(fp_string_compare(concat, "Hello World!") == 0);
 		fp_string_concatenate_inplace(concat, " bob");
 		CHECK(fp_string_compare(concat, "Hello World! bob") == 0);
+		CHECK(strlen(concat) == fp_string_length(concat));
+
+		fp_string empty = nullptr;
+		fp_string_concatenate_inplace(empty, "abc");
+		CHECK(fp_string_length(empty) == 3);
+		CHECK(strlen(empty) == 3);
+		fp_string_concatenate_inplace(empty, "defgh");
+		CHECK(strlen(empty) == 8);
+		fp_string_free(empty);
 		CHECK(fp_string_contains(concat, "World!", 0));
 		CHECK(fp_string_find(concat, "World!", 0) == 6);
 		CHECK(fp_string_find(concat, "Not here!", 0) == fp_not_found);
@@ -369,6 +726,316 @@ TEST_SUITE("LibFP") {
 		fp_string_free(str);
 	}
 
+	TEST_CASE("String::Replace") {
+		test_random random{99};
+		bool copies = true, inplace = true;
+		for(size_t round = 0; round < 300; ++round) {
+			std::string text = random.string(1 + random() % 200, 'a', 2), find = random.string(1 + random() % 4, 'a', 2), with(random() % 7, 'x');
+			size_t start = random() % (text.size() + 1);
+
+			std::string expected = text;
+			for(size_t at = expected.find(find, start); at != std::string::npos; at = expected.find(find, at + with.size()))
+				expected.replace(at, find.size(), with);
+
+			fp_string copy = fp_string_view_replace(view(text), view(find), view(with), start);
+			REQUIRE(copy != nullptr);
+			copies &= expected == std::string(copy, fp_string_length(copy)) && copy[fp_string_length(copy)] == 0;
+			fp_string_free(copy);
+
+			fp_string str = fp_string_view_make_dynamic(view(text));
+			fp_string_replace_inplace(&str, view(find), view(with), start);
+			inplace &= expected == std::string(str, fp_string_length(str)) && str[fp_string_length(str)] == 0;
+			fp_string_free(str);
+		}
+		CHECK(copies);
+		CHECK(inplace);
+
+		fp_string unchanged = fp_string_view_replace(fp_string_view_from_literal("abc"), fp_string_view_from_literal(""), fp_string_view_from_literal("x"), 0);
+		CHECK(fp_string_equal(unchanged, "abc")); // Empty patterns never match
+		fp_string_free(unchanged);
+
+		fp_string vanished = fp_string_view_replace(fp_string_view_from_literal("abab"), fp_string_view_from_literal("ab"), fp_string_view_from_literal(""), 0);
+		REQUIRE(vanished != nullptr); // Replacing everything by nothing still returns a string
+		CHECK(fp_string_length(vanished) == 0);
+		CHECK(vanished[0] == 0);
+		fp_string_free(vanished);
+
+		fp_string empty = nullptr;
+		CHECK(fp_string_replace_inplace(&empty, fp_string_view_from_literal("a"), fp_string_view_from_literal("bc"), 0) == nullptr);
+		CHECK(fp_string_replace_inplace(&empty, fp_string_view_from_literal(""), fp_string_view_from_literal("bc"), 0) == nullptr);
+		CHECK(empty == nullptr);
+	}
+
+	TEST_CASE("String::Format") {
+		fp_string str = NULL;
+		fp_string_format_append(str, "%s", "");
+		CHECK(str == nullptr); // Empty output doesn't allocate
+		fp_string empty = fp_string_format("%s", "");
+		REQUIRE(empty != nullptr); // ... but formatting always returns a string
+		CHECK(fp_string_length(empty) == 0);
+		CHECK(strlen(empty) == 0);
+		fp_string_free(empty);
+		for(int i = 0; i < 1000; ++i)
+			fp_string_format_append(str, "%d,", i);
+		std::string expected;
+		for(int i = 0; i < 1000; ++i) expected += std::to_string(i) + ",";
+		CHECK(expected == std::string(str, fp_string_length(str)));
+		CHECK(str[fp_string_length(str)] == 0);
+
+		fpda_clear(str);
+		fp_string_format_append(str, "%s", expected.c_str()); // Fits the spare capacity exactly
+		CHECK(expected == std::string(str, fp_string_length(str)));
+		fp_string_format_append(str, "%s", "!");
+		CHECK(fp_string_length(str) == expected.size() + 1);
+		CHECK(fp_string_ends_with(str, "999,!", 0));
+		fp_string_free(str);
+
+		std::string large(1000, 'x'); // Larger than the stack buffer
+		fp_string formatted = fp_string_format("[%s]", large.c_str());
+		CHECK(fp_string_length(formatted) == 1002);
+		CHECK(formatted[1002] == 0);
+		fp_string_free(formatted);
+
+		std::string format(300, ' '); // Long (non null terminated) views are copied to the heap
+		format += "%d|";
+		fp_string viewed = fp_string_view_format(fp_string_view_literal(format.data(), format.size() - 1), 42);
+		CHECK(std::string(viewed) == std::string(300, ' ') + "42");
+		fp_string_free(viewed);
+		viewed = fp_string_view_format(fp_string_view_literal(format.data() + 300, 2), 7);
+		CHECK(fp_string_equal(viewed, "7"));
+		fp_string_free(viewed);
+	}
+
+	TEST_CASE("String::Find") {
+		test_random random{12345};
+
+		bool matches = true;
+		for(size_t alphabet : {2, 4, 26})
+			for(size_t round = 0; round < 200; ++round) {
+				std::string haystack = random.string(random() % 300, 'a', alphabet);
+				std::string needle = random.string(1 + random() % 80, 'a', alphabet);
+				if(round % 3 == 0 && needle.size() < haystack.size()) // Make sure some searches succeed
+					needle = haystack.substr(random() % (haystack.size() - needle.size()), needle.size());
+				size_t start = haystack.empty() ? 0 : random() % haystack.size();
+				size_t expected = haystack.find(needle, start);
+				matches &= fp_string_view_find(view(haystack), view(needle), start) == (expected == std::string::npos ? fp_not_found : expected);
+			}
+		CHECK(matches);
+
+		// Periodic needles which only match at the very end
+		std::string periodic(10000, 'a'), needle(100, 'a');
+		periodic += 'b';
+		needle += 'b';
+		CHECK(fp_string_view_find(view(periodic), view(needle), 0) == 9900);
+		needle = "ab" + std::string(60, 'a') + "b";
+		CHECK(fp_string_view_find(view(periodic), view(needle), 0) == fp_not_found);
+		CHECK(fp_string_view_find(view(periodic), view(""), 5) == 5);
+		CHECK(fp_string_view_contains(view(periodic), view(std::string(40, 'a') + "b"), 0));
+	}
+
+	TEST_CASE("String::Searcher") {
+		test_random random{54321};
+
+		bool matches = true;
+		for(size_t alphabet : {2, 4, 26})
+			for(size_t round = 0; round < 200; ++round) {
+				std::string haystack = random.string(random() % 300, 'a', alphabet);
+				std::string needle = random.string(1 + random() % 80, round % 2 ? 'a' : 'A', alphabet); // Upper case bytes are "rare"
+				if(round % 3 == 0 && needle.size() < haystack.size())
+					needle = haystack.substr(random() % (haystack.size() - needle.size()), needle.size());
+				auto searcher = fp_string_searcher_create(view(needle));
+				size_t start = haystack.empty() ? 0 : random() % haystack.size();
+				matches &= fp_string_searcher_find(&searcher, view(haystack), start) == fp_string_view_find(view(haystack), view(needle), start);
+			}
+		CHECK(matches);
+
+		std::string log = "id=1 id=22 id=333 id=";
+		for(const char* needle : {"id=", "id=22 id=333", "id=1 id=22 id=333 id=4444444444444444444"}) {
+			auto searcher = fp_string_searcher_create(fp_string_view_from_literal(needle));
+			size_t expected = std::string(needle) == "id=" ? 4 : std::string(needle).size() > log.size() ? 0 : 1;
+			CHECK(fp_string_searcher_count(&searcher, view(log)) == expected);
+		}
+
+		auto id = fp_string_searcher_create(fp_string_view_from_literal("id="));
+		fp_dynarray(size_t) hits = fp_string_searcher_find_all(&id, view(log));
+		REQUIRE(fpda_size(hits) == 4);
+		CHECK(hits[0] == 0);
+		CHECK(hits[3] == 18);
+		fp_string_searcher_find_all_inplace(&id, fp_string_view_from_literal("xid="), &hits); // Appends
+		CHECK(fpda_size(hits) == 5);
+		CHECK(hits[4] == 1);
+		fpda_free_and_null(hits);
+
+		auto empty = fp_string_searcher_create(fp_string_view_from_literal(""));
+		CHECK(fp_string_searcher_count(&empty, fp_string_view_from_literal("abc")) == 4);
+	}
+
+	TEST_CASE("String::Split") {
+		fp_dynarray(fp_string_view) parts = fp_string_view_split(fp_string_view_from_literal(",a,,b c,"), fp_string_view_from_literal(", "));
+		REQUIRE(fpda_size(parts) == 6);
+		CHECK(fp_string_view_length(parts[0]) == 0);
+		CHECK(fp_string_view_equal(parts[1], fp_string_view_from_literal("a")));
+		CHECK(fp_string_view_equal(parts[4], fp_string_view_from_literal("c")));
+		CHECK(fp_string_view_length(parts[5]) == 0);
+		fpda_free_and_null(parts);
+
+		test_random random{4242};
+		bool finds = true, pieces = true;
+		for(size_t round = 0; round < 300; ++round) {
+			std::string haystack(random() % 200, 'a'), delimiters(random() % 8, 'a');
+			for(auto& c: haystack) c = (char)(random() % 16 * 13); // A few byte values, some of them negative as chars
+			for(auto& c: delimiters) c = (char)(random() % 16 * 13);
+			auto set = fp_byte_set_create(view(delimiters));
+			size_t start = random() % (haystack.size() + 1);
+			size_t expected = haystack.find_first_of(delimiters, start);
+			finds &= fp_byte_set_find(&set, view(haystack), start) == (expected == std::string::npos ? fp_not_found : expected);
+
+			auto it = fp_string_view_split_lazy(view(haystack), view(delimiters));
+			fp_string_view piece;
+			size_t from = 0, to;
+			do {
+				to = haystack.find_first_of(delimiters, from);
+				if(to == std::string::npos) to = haystack.size();
+				pieces &= fp_string_split_next(&it, &piece) && fp_view_data(char, piece) == haystack.data() + from && fp_view_size(piece) == to - from;
+				from = to + 1;
+			} while(to < haystack.size());
+			pieces &= !fp_string_split_next(&it, &piece);
+		}
+		CHECK(finds);
+		CHECK(pieces);
+	}
+
+	TEST_CASE("String::CSV") {
+		auto csv = fp_csv_parser_create(fp_string_view_from_literal("id,name,note\r\n1,\"Smith, J\",\"say \"\"hi\"\"\"\n\n2,,a\rb\n3,\"open"), ',', '"');
+		fp_dynarray(fp_string_view) fields = NULL;
+		REQUIRE(fp_csv_parser_next_record(&csv, &fields));
+		CHECK(fpda_size(fields) == 3);
+		CHECK(fp_string_view_equal(fields[2], fp_string_view_from_literal("note")));
+		REQUIRE(fp_csv_parser_next_record(&csv, &fields));
+		REQUIRE(fpda_size(fields) == 3);
+		CHECK(fp_string_view_equal(fields[1], fp_string_view_from_literal("Smith, J")));
+		CHECK(fp_string_view_equal(fields[2], fp_string_view_from_literal("say \"\"hi\"\"")));
+		fp_string unescaped = fp_csv_field_unescape(fields[2], '"');
+		CHECK(fp_string_equal(unescaped, "say \"hi\""));
+		fp_string_free_and_null(unescaped);
+		REQUIRE(fp_csv_parser_next_record(&csv, &fields)); // Empty line
+		CHECK(fpda_size(fields) == 1);
+		CHECK(fp_string_view_length(fields[0]) == 0);
+		REQUIRE(fp_csv_parser_next_record(&csv, &fields));
+		REQUIRE(fpda_size(fields) == 3);
+		CHECK(fp_string_view_length(fields[1]) == 0);
+		CHECK(fp_string_view_equal(fields[2], fp_string_view_from_literal("a\rb"))); // A lone \r is content
+		REQUIRE(fp_csv_parser_next_record(&csv, &fields));
+		REQUIRE(fpda_size(fields) == 2);
+		CHECK(fp_string_view_equal(fields[1], fp_string_view_from_literal("open"))); // Unterminated quote
+		CHECK(!fp_csv_parser_next_record(&csv, &fields));
+
+		csv = fp_csv_parser_create(fp_string_view_from_literal("a,"), ',', '"');
+		struct fp_csv_field field;
+		REQUIRE(fp_csv_parser_next(&csv, &field));
+		CHECK(!field.end_of_record);
+		REQUIRE(fp_csv_parser_next(&csv, &field)); // Trailing delimiter, one more empty field
+		CHECK(field.end_of_record);
+		CHECK(fp_string_view_length(field.value) == 0);
+		CHECK(!fp_csv_parser_next(&csv, &field));
+		csv = fp_csv_parser_create(fp_string_view_from_literal(""), ',', '"');
+		CHECK(!fp_csv_parser_next(&csv, &field));
+
+		// Unquoted TSV spanning many blocks agrees with splitting every line
+		std::string tsv;
+		for(size_t i = 0; i < 500; ++i)
+			tsv += std::to_string(i) + "\t" + std::string(i % 70, 'x') + "\t\"" + (i % 3 ? "\r\n" : "\n");
+		csv = fp_csv_parser_create(fp_string_view_literal(tsv.data(), tsv.size()), '\t', 0);
+		size_t records = 0;
+		bool agrees = true;
+		while(fp_csv_parser_next_record(&csv, &fields)) {
+			std::string expected_middle(records % 70, 'x');
+			agrees &= fpda_size(fields) == 3 && fp_string_view_equal(fields[1], fp_string_view_literal(expected_middle.data(), expected_middle.size()))
+				&& fp_string_view_equal(fields[2], fp_string_view_from_literal("\""));
+			++records;
+		}
+		CHECK(records == 500);
+		CHECK(agrees);
+		fpda_free_and_null(fields);
+	}
+
+	TEST_CASE("String::Aho_Corasick") {
+		fp_dynarray(fp_string_view) keywords = NULL;
+		for(const char* keyword : {"he", "she", "his", "hers", "", "he"})
+			fpda_push_back(keywords, fp_string_view_from_literal(keyword));
+		auto ac = fp_aho_corasick_create(keywords);
+		CHECK(fp_aho_corasick_pattern_count(&ac) == 6);
+
+		fp_dynarray(struct fp_aho_corasick_match) hits = fp_aho_corasick_find_all(&ac, fp_string_view_from_literal("ushers"));
+		REQUIRE(fpda_size(hits) == 3); // Empty and duplicate patterns are never reported
+		CHECK((hits[0].pattern == 1 && hits[0].offset == 1 && hits[0].length == 3));
+		CHECK((hits[1].pattern == 0 && hits[1].offset == 2));
+		CHECK((hits[2].pattern == 3 && hits[2].offset == 2));
+		fp_aho_corasick_find_all_inplace(&ac, fp_string_view_from_literal("this"), &hits); // Appends
+		CHECK(fpda_size(hits) == 4);
+		CHECK(hits[3].pattern == 2);
+		fpda_free_and_null(hits);
+
+		struct fp_aho_corasick_match first;
+		REQUIRE(fp_aho_corasick_find(&ac, fp_string_view_from_literal("ushers"), 0, &first));
+		CHECK(first.pattern == 1);
+		CHECK(!fp_aho_corasick_find(&ac, fp_string_view_from_literal("ushers"), 4, &first));
+		CHECK(fp_aho_corasick_count(&ac, fp_string_view_from_literal("she sells hershey")) == 6);
+
+		fp_string_view with[] = {fp_string_view_from_literal("1"), fp_string_view_from_literal("2"), fp_string_view_from_literal("3"),
+			fp_string_view_from_literal("4"), fp_string_view_from_literal("5"), fp_string_view_from_literal("6")};
+		fp_string replaced = fp_string_view_replace_all_multi(fp_string_view_from_literal("ushers, his hers"), &ac, with);
+		CHECK(fp_string_equal(replaced, "u2rs, 3 4"));
+		fp_string_free_and_null(replaced);
+		fp_aho_corasick_free(&ac);
+		fpda_free_and_null(keywords);
+
+		// Randomized against a per pattern search
+		test_random random{777};
+		bool counts = true, replacements = true;
+		for(size_t round = 0; round < 100; ++round) {
+			std::string haystack = random.string(random() % 400, 'a', 3);
+			std::vector<std::string> patterns(1 + random() % 12);
+			for(auto& pattern: patterns) {
+				pattern = random.string(1 + random() % 5, 'a', 3);
+				fpda_push_back(keywords, view(pattern));
+			}
+			ac = fp_aho_corasick_create(keywords);
+
+			size_t expected = 0;
+			for(size_t p = 0; p < patterns.size(); ++p)
+				if(std::find(patterns.begin(), patterns.begin() + p, patterns[p]) == patterns.begin() + p)
+					for(size_t at = haystack.find(patterns[p]); at != std::string::npos; at = haystack.find(patterns[p], at + 1))
+						++expected;
+			counts &= fp_aho_corasick_count(&ac, view(haystack)) == expected;
+
+			std::vector<std::string> replacement_strings(patterns.size());
+			std::vector<fp_string_view> replacement_views;
+			for(size_t p = 0; p < patterns.size(); ++p) {
+				replacement_strings[p] = "<" + std::to_string(p) + ">";
+				replacement_views.push_back(view(replacement_strings[p]));
+			}
+			std::string naive;
+			for(size_t i = 0; i < haystack.size(); ) {
+				size_t best = patterns.size();
+				for(size_t p = 0; p < patterns.size(); ++p)
+					if(haystack.compare(i, patterns[p].size(), patterns[p]) == 0 && (best == patterns.size() || patterns[p].size() > patterns[best].size()))
+						best = p;
+				if(best == patterns.size()) naive += haystack[i++];
+				else { naive += replacement_strings[best]; i += patterns[best].size(); }
+			}
+			replaced = fp_string_view_replace_all_multi(view(haystack), &ac, replacement_views.data());
+			replacements &= naive == std::string(replaced ? replaced : "");
+			fp_string_free_and_null(replaced);
+
+			fp_aho_corasick_free(&ac);
+			fpda_clear(keywords);
+		}
+		CHECK(counts);
+		CHECK(replacements);
+		fpda_free_and_null(keywords);
+	}
+
 	TEST_CASE("String::Equal_Replace") {
 		auto str = fp_string_replicate("ball", 5);
 		auto replaced = fp_string_replace(str, "ball", "look", 0);
@@ -390,6 +1057,125 @@ TEST_SUITE("LibFP") {
 		fp_string_free(utf8);
 	}
 
+	TEST_CASE("UTF8::Decode") {
+		CHECK(fp_string_view_codepoint_count(fp_string_view_from_literal("Hello, 世界")) == 9);
+		CHECK(fp_string_view_to_codepoints(fp_string_view_from_literal("")) == nullptr);
+		for(const char* invalid : {"\x80", "ab\xC3", "\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xE4\xB8x", "\xF0\x9F\x98"})
+			CHECK(fp_string_view_to_codepoints(fp_string_view_from_literal(invalid)) == nullptr);
+
+		// Random texts (long ASCII runs broken up by multi byte sequences) round trip
+		test_random random{31337};
+		bool round_trips = true, truncations = true;
+		for(size_t round = 0; round < 200; ++round) {
+			std::vector<uint32_t> codepoints(random() % 300);
+			for(auto& c: codepoints) switch(random() % 8) {
+				case 0: c = 0x80 + random() % 0x780; break;
+				case 1: c = 0x800 + random() % 0xD000; break;
+				case 2: c = 0x10000 + (random() << 4 | random() % 16) % 0x100000; break;
+				default: c = random() % 0x80;
+			}
+			std::string text;
+			for(uint32_t c: codepoints) {
+				char buffer[4];
+				text.append(buffer, fp_encode_utf8(c, buffer));
+			}
+			fp_dynarray(uint32_t) decoded = fp_string_view_to_codepoints(view(text));
+			round_trips &= fpda_size(decoded) == codepoints.size() && (codepoints.empty() || memcmp(decoded, codepoints.data(), codepoints.size() * 4) == 0);
+			fpda_free(decoded);
+
+			if(!text.empty() && (uint8_t)text.back() >= 0x80) // Cutting the last sequence short makes the text invalid
+				truncations &= fp_string_view_to_codepoints(fp_string_view_literal((char*)text.data(), text.size() - 1)) == nullptr;
+		}
+		CHECK(round_trips);
+		CHECK(truncations);
+	}
+
+	TEST_CASE("UTF8::Encode") {
+		uint32_t too_big[] = {'a', 'b', 0x110000};
+		CHECK(fp_codepoints_view_to_string(fp_view_literal(uint32_t, too_big, 3)) == nullptr);
+		uint32_t too_big_simd[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 0xFFFFFFFF, 'i'};
+		CHECK(fp_codepoints_view_utf8_length(fp_view_literal(uint32_t, too_big_simd, 9)) == SIZE_MAX);
+
+		// Runs of ASCII, of two byte codepoints and mixed blocks all match the one codepoint at a time encoder
+		test_random random{2718};
+		bool matches = true;
+		for(size_t round = 0; round < 200; ++round) {
+			std::vector<uint32_t> codepoints(random() % 300);
+			uint32_t kind = 0;
+			for(auto& c: codepoints) {
+				if(random() % 16 == 0) kind = random() % 4;
+				switch(kind) {
+					case 0: c = random() % 0x80; break;
+					case 1: c = 0x80 + random() % 0x780; break;
+					case 2: c = 0x800 + random() % 0xF000; break;
+					default: c = 0x10000 + (random() << 4 | random() % 16) % 0x100000;
+				}
+			}
+			std::string expected;
+			for(uint32_t c: codepoints) {
+				char buffer[4];
+				expected.append(buffer, fp_encode_utf8(c, buffer));
+			}
+			fp_string encoded = fp_codepoints_view_to_string(fp_view_literal(uint32_t, codepoints.data(), codepoints.size()));
+			matches &= fp_codepoints_view_utf8_length(fp_view_literal(uint32_t, codepoints.data(), codepoints.size())) == expected.size();
+			matches &= expected == (encoded ? std::string(encoded, fp_string_length(encoded)) : std::string()) && (!encoded || encoded[fp_string_length(encoded)] == 0);
+			fp_string_free(encoded);
+		}
+		CHECK(matches);
+	}
+
+	TEST_CASE("UTF8::View") {
+		fp_string_view text = fp_string_view_from_literal("a\xC3\xA9\xE4\xB8\x96\xF0\x9F\x8C\x8D!"); // a é 世 🌍 !
+		uint32_t expected[] = {'a', 0xE9, 0x4E16, 0x1F30D, '!'};
+		size_t offset = 0, i = 0;
+		uint32_t codepoint;
+		while(fp_string_view_next_codepoint(text, &offset, &codepoint))
+			CHECK(codepoint == expected[i++]);
+		CHECK(i == 5);
+		offset = 0;
+		CHECK(fp_string_view_next_codepoint(fp_string_view_from_literal("\x80"), &offset, &codepoint));
+		CHECK(codepoint == FP_UTF8_REPLACEMENT_CHARACTER);
+
+		size_t offsets[] = {0, 1, 3, 6, 10, 11};
+		for(size_t c = 0; c <= 5; ++c)
+			CHECK(fp_string_view_codepoint_offset(text, c) == offsets[c]);
+		CHECK(fp_string_view_codepoint_offset(text, 6) == fp_not_found);
+		CHECK(fp_string_view_codepoint_index(text, 4) == 2); // Inside 世
+		CHECK(fp_string_view_codepoint_index(text, 10) == 4);
+
+		// A long text, looked up directly and through sparse indices of different strides
+		std::string long_text;
+		std::vector<size_t> starts;
+		for(size_t c = 0; c < 3000; ++c) {
+			starts.push_back(long_text.size());
+			long_text += c % 7 == 0 ? "\xE4\xB8\x96" : c % 5 == 0 ? "\xC3\xA9" : "x";
+		}
+		auto long_view = fp_string_view_literal(long_text.data(), long_text.size());
+		struct fp_utf8_index dense = fp_utf8_index_create(long_view, 1), sparse = fp_utf8_index_create(long_view, 0);
+		CHECK(sparse.count == 3000);
+		bool lookups = true;
+		for(size_t c = 0; c < 3000; ++c) {
+			lookups &= fp_string_view_codepoint_offset(long_view, c) == starts[c];
+			lookups &= fp_utf8_index_offset(&sparse, long_view, c) == starts[c] && fp_utf8_index_offset(&dense, long_view, c) == starts[c];
+			lookups &= fp_utf8_index_codepoint(&sparse, long_view, starts[c]) == c && fp_utf8_index_codepoint(&dense, long_view, starts[c]) == c;
+			if(c % 7 == 0) lookups &= fp_utf8_index_codepoint(&sparse, long_view, starts[c] + 2) == c;
+		}
+		CHECK(lookups);
+		CHECK(fp_utf8_index_offset(&sparse, long_view, 3000) == long_text.size());
+		CHECK(fp_utf8_index_offset(&sparse, long_view, 3001) == fp_not_found);
+		fp_utf8_index_free(&dense);
+		fp_utf8_index_free(&sparse);
+
+		// Zoe with a combining diaeresis, a woman technologist (ZWJ sequence), a thumbs up with a skin tone, a flag and CRLF
+		fp_string_view graphemes = fp_string_view_from_literal("Zoe\xCC\x88 \xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x92\xBB\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD\xF0\x9F\x87\xAB\xF0\x9F\x87\xB7\r\n");
+		CHECK(fp_string_view_grapheme_count(graphemes) == 8);
+		CHECK(fp_string_view_equal(fp_string_view_grapheme_subview(graphemes, 2, 1), fp_string_view_from_literal("e\xCC\x88")));
+		CHECK(fp_string_view_equal(fp_string_view_grapheme_subview(graphemes, 4, 1), fp_string_view_from_literal("\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x92\xBB")));
+		CHECK(fp_view_size(fp_string_view_grapheme_subview(graphemes, 6, 1)) == 8); // Two regional indicators
+		CHECK(fp_string_view_equal(fp_string_view_grapheme_subview(graphemes, 7, 5), fp_string_view_from_literal("\r\n")));
+		CHECK(fp_view_size(fp_string_view_grapheme_subview(graphemes, 9, 1)) == 0);
+	}
+
 	TEST_CASE("Hashtable") {
 		fp_hashtable(int) table = fp_create_default_hash_table(int);
 		CHECK(table != nullptr);
@@ -400,7 +1186,7 @@ TEST_SUITE("LibFP") {
 		CHECK(*v == key);
 
 		auto p = fpht_find_position(table, key);
-		CHECK(p == 6);
+		CHECK(p == 2);
 		CHECK(table[p] == key);
 		v = fpht_find(table, key);
 		CHECK(*v == key);
@@ -435,6 +1221,262 @@ TEST_SUITE("LibFP") {
 		fpht_free_and_null(table);
 	}
 
+	TEST_CASE("Hashtable - Power of two") {
+		auto config = fpht_default_config();
+		config.base_size = 12;
+		fp_hashtable(int) table = fp_create_hash_table(int, config);
+		CHECK(fpda_size(table) == 16);
+
+		// Weak hashes (here the identity) of keys sharing their low bits still spread over the table
+		config.hash_function = [](const fp_void_view key) noexcept -> uint64_t { return *(int*)fp_view_data_void(key); };
+		fp_hashtable(int) weak = fp_create_hash_table(int, config);
+		bool inserted = true, found = true;
+		for(int i = 0; i < 1000; ++i) {
+			int key = i * 1024;
+			inserted &= fpht_insert(weak, key) != nullptr;
+		}
+		for(int i = 0; i < 1000; ++i) {
+			int key = i * 1024;
+			found &= fpht_contains(weak, key);
+		}
+		CHECK(inserted);
+		CHECK(found);
+		CHECK(fpda_size(weak) <= 16384);
+		CHECK((fpda_size(weak) & (fpda_size(weak) - 1)) == 0);
+
+		fpht_free_and_null(table);
+		fpht_free_and_null(weak);
+	}
+
+	TEST_CASE("Hashtable - Hopscotch") {
+		uint64_t seed = 7;
+		auto random = [&] { seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17; return seed; };
+
+		// Entries are displaced to make room, so the table fills up well before having to grow
+		auto config = fpht_default_config();
+		config.base_size = 1024;
+		config.max_load_factor = 1;
+		fp_hashtable(uint64_t) table = fp_create_hash_table(uint64_t, config);
+		size_t inserted = 0;
+		while(fpda_size(table) == 1024) {
+			uint64_t key = random();
+			fpht_insert(table, key);
+			++inserted;
+		}
+		CHECK(inserted > 1024 * 3 / 4);
+		fpht_free_and_null(table);
+
+		// Random inserts and removals, checked against a reference set
+		table = fp_create_default_hash_table(uint64_t);
+		std::unordered_set<uint64_t> reference;
+		bool consistent = true;
+		for(size_t round = 0; round < 20000; ++round) {
+			uint64_t key = random() % 4096;
+			if(random() % 3) {
+				fpht_insert(table, key);
+				reference.insert(key);
+			} else {
+				fpht_remove(table, key);
+				reference.erase(key);
+			}
+			if(round % 1000 == 0)
+				for(uint64_t k = 0; k < 4096; ++k)
+					consistent &= fpht_contains(table, k) == (reference.count(k) > 0);
+		}
+		CHECK(consistent);
+		CHECK(fpht_occupied_size(table) == reference.size());
+		fpht_free_and_null(table);
+	}
+
+	TEST_CASE("Hashtable - Load factor") {
+		for(auto engine: {FP_HASH_TABLE_ENGINE_HOPSCOTCH, FP_HASH_TABLE_ENGINE_SWISS}) {
+			auto config = fpht_default_config();
+			config.engine = engine;
+			config.base_size = 64;
+			config.max_load_factor = .5f;
+			fp_hashtable(int) table = fp_create_hash_table(int, config);
+			for(int i = 0; i < 32; ++i)
+				fpht_insert(table, i);
+			CHECK(fpht_occupied_size(table) == 32);
+			CHECK(fpda_size(table) == 64);
+			int key = 32;
+			fpht_insert(table, key); // Would fill more than half the table
+			CHECK(fpda_size(table) == 128);
+			CHECK(fpht_occupied_size(table) == 33);
+			fpht_remove(table, key);
+			fpht_remove(table, key);
+			CHECK(fpht_occupied_size(table) == 32);
+
+			// Reserving grows once, up front
+			REQUIRE(fpht_reserve(table, 1000) == fp_not_found);
+			CHECK(fpda_size(table) == 2048);
+			CHECK(fpht_reserve(table, 1000) == fp_not_found);
+			for(int i = 0; i < 1000; ++i)
+				fpht_insert(table, i);
+			CHECK(fpda_size(table) == 2048);
+			CHECK(fpht_occupied_size(table) == 1000);
+
+			fpht_clear(table);
+			CHECK(fpda_size(table) == 2048);
+			CHECK(fpht_occupied_size(table) == 0);
+			CHECK(fpht_find_first_occupied(table) == nullptr);
+			key = 0;
+			fpht_insert(table, key);
+			CHECK(fpht_find_first_occupied_position(table) == fpht_find_last_occupied_position(table));
+			fpht_free_and_null(table);
+
+			fp_dynarray(int) values = nullptr;
+			for(int i = 0; i < 5000; ++i)
+				fpda_push_back(values, i);
+			table = fp_create_hash_table_from_array(values, config);
+			CHECK(fpda_size(table) == 16384); // Sized for 5000 entries at once, rather than doubled 8 times
+			CHECK(fpht_occupied_size(table) == 5000);
+			fpht_free_and_null(table);
+			fpda_free_and_null(values);
+		}
+	}
+
+	TEST_CASE("Hashtable - Stored hashes") {
+		static size_t hashed, compared;
+		for(auto engine: {FP_HASH_TABLE_ENGINE_HOPSCOTCH, FP_HASH_TABLE_ENGINE_SWISS}) {
+			auto config = fpht_default_config();
+			config.engine = engine;
+			config.store_hashes = true;
+			config.hash_function = [](const fp_void_view key) noexcept { ++hashed; return fp_fnv1a_hash_void(key); };
+			config.compare_function = [](const fp_void_view a, const fp_void_view b) noexcept { ++compared; return fp_view_equal(a, b); };
+			fp_hashtable(int) table = fp_create_hash_table(int, config);
+			for(int i = 0; i < 1000; ++i)
+				fpht_insert(table, i);
+			CHECK(fpht_occupied_size(table) == 1000);
+
+			// Growing moves the entries along with their hashes instead of hashing them again
+			hashed = 0;
+			REQUIRE(fpht_double_size_and_rehash(table) == fp_not_found);
+			REQUIRE(fpht_reserve(table, 10000) == fp_not_found);
+			CHECK(hashed == 0);
+
+			// Only keys whose whole hash matches are compared
+			compared = 0;
+			bool found = true, missing = true;
+			for(int i = 0; i < 1000; ++i) {
+				int key = i, other = i + 1000;
+				found &= fpht_find(table, key) != nullptr && *fpht_find(table, key) == i;
+				missing &= !fpht_contains(table, other);
+			}
+			CHECK(found);
+			CHECK(missing);
+			CHECK(compared == 2000);
+
+			int key = 500;
+			fpht_remove(table, key);
+			CHECK(!fpht_contains(table, key));
+			fpht_insert(table, key);
+			CHECK(fpht_contains(table, key));
+			fpht_free_and_null(table);
+		}
+	}
+
+	TEST_CASE("Hashtable - Swiss") {
+		auto config = fpht_default_config();
+		config.engine = FP_HASH_TABLE_ENGINE_SWISS;
+		fp_hashtable(int) table = fp_create_hash_table(int, config);
+		CHECK(fpda_size(table) == FP_HASH_TABLE_GROUP_SIZE);
+
+		int key = 5;
+		auto v = fpht_insert(table, key);
+		CHECK(*v == 5);
+		CHECK(fpht_insert(table, key) == v);
+		CHECK(fpht_find(table, key) == v);
+		key = 6;
+		CHECK(fpht_find(table, key) == nullptr);
+
+		bool inserted = true, found = true, missing = true;
+		for(int i = 0; i < 5000; ++i)
+			inserted &= fpht_insert(table, i) != nullptr;
+		for(int i = 0; i < 5000; ++i) {
+			found &= fpht_contains(table, i);
+			int other = i + 5000;
+			missing &= !fpht_contains(table, other);
+		}
+		CHECK(inserted);
+		CHECK(found);
+		CHECK(missing);
+		CHECK(fpht_occupied_size(table) == 5000);
+
+		// Removing leaves tombstones behind which mustn't break the probe sequences of other keys
+		for(int i = 0; i < 5000; i += 2)
+			fpht_remove(table, i);
+		found = true; missing = true;
+		for(int i = 0; i < 5000; ++i)
+			if(i % 2) found &= fpht_contains(table, i);
+			else missing &= !fpht_contains(table, i);
+		CHECK(found);
+		CHECK(missing);
+		for(int i = 0; i < 5000; i += 2)
+			fpht_insert(table, i);
+		CHECK(fpht_occupied_size(table) == 5000);
+
+		size_t size = fpda_size(table);
+		REQUIRE(fpht_double_size_and_rehash(table) == fp_not_found);
+		CHECK(fpda_size(table) == size * 2);
+		REQUIRE(fpht_rehash(table) == fp_not_found);
+		found = true;
+		for(int i = 0; i < 5000; ++i)
+			found &= *fpht_find(table, i) == i;
+		CHECK(found);
+		fpht_free_and_null(table);
+
+		fp_dynarray(int) values = nullptr;
+		for(int i = 0; i < 100; ++i)
+			fpda_push_back(values, i * 3);
+		table = fp_create_hash_table_from_array(values, config);
+		CHECK(fpht_occupied_size(table) == 100);
+		key = 297;
+		CHECK(fpht_contains(table, key));
+		fpht_free_and_null(table);
+		fpda_free_and_null(values);
+	}
+
+	TEST_CASE("Hashtable - Swiss churn") {
+		auto config = fpht_default_config();
+		config.engine = FP_HASH_TABLE_ENGINE_SWISS;
+		fp_hashtable(int) table = fp_create_hash_table(int, config);
+		for(int i = 0; i < 1600; ++i)
+			fpht_insert(table, i);
+		size_t size = fpda_size(table);
+
+		// Replacing keys leaves tombstones behind, which have to be cleared before every group is out of empty cells
+		bool found = true;
+		for(int i = 0; i < 100000; ++i) {
+			int added = i + 1600;
+			fpht_remove(table, i);
+			fpht_insert(table, added);
+			found &= fpht_contains(table, added);
+		}
+		CHECK(found);
+		CHECK(fpht_occupied_size(table) == 1600);
+		CHECK(fpda_size(table) <= size * 2); // The table may double once, otherwise rehashing in place clears the tombstones
+		auto h = __fpht_header(table);
+		CHECK((float)(h->count + h->deleted) <= config.max_load_factor * fpda_size(table));
+
+		// Misses stop probing at the first group with an empty cell, which should (almost always) be the first one
+		size_t groups_mask = fpda_size(table) / FP_HASH_TABLE_GROUP_SIZE - 1, probes = 0;
+		bool missing = true;
+		for(int i = 0; i < 10000; ++i) {
+			int absent = -1 - i;
+			missing &= !fpht_contains(table, absent);
+			uint64_t hash = __fpht_hash_full(table, fp_void_view_literal(&absent, sizeof(absent)));
+			size_t group = (hash >> 7) & groups_mask;
+			for(size_t probe = 0; ; group = (group + ++probe) & groups_mask) {
+				++probes;
+				if(__fpht_group_match(h->control + group * FP_HASH_TABLE_GROUP_SIZE, __FPHT_CONTROL_EMPTY) || probe == groups_mask) break;
+			}
+		}
+		CHECK(missing);
+		CHECK(probes < 10000 * 2);
+		fpht_free_and_null(table);
+	}
+
 	TEST_CASE("Hashtable from view") {
 		float* values = fp_alloca(float, 5);
 		for(size_t i = 0; i < fp_size(values); ++i)
@@ -461,10 +1503,431 @@ TEST_SUITE("LibFP") {
 		fpht_free_and_null(table);
 	}
 
+#ifdef FP_ENABLE_BENCHMARKING
+	TEST_CASE("Dynamic Array - Growth Benchmark") {
+		constexpr size_t count = 4 * 1024 * 1024; // 32MiB of uint64_t
+
+		ankerl::nanobench::Bench bench;
+		bench.title("push_back growth").unit("push_back").batch(count).relative(true).minEpochIterations(3);
+
+		bench.run("malloc + memcpy + free", [&] {
+			uint64_t* data = (uint64_t*)malloc(sizeof(uint64_t));
+			size_t capacity = 1;
+			for(size_t i = 0; i < count; ++i) {
+				if(i == capacity) {
+					auto grown = (uint64_t*)malloc(sizeof(uint64_t) * capacity * 2);
+					memcpy(grown, data, sizeof(uint64_t) * capacity);
+					free(data);
+					data = grown;
+					capacity *= 2;
+				}
+				data[i] = i;
+			}
+			ankerl::nanobench::doNotOptimizeAway(data);
+			free(data);
+		});
+
+		bench.run("fpda_push_back (realloc)", [&] {
+			fp_dynarray(uint64_t) data = nullptr;
+			for(size_t i = 0; i < count; ++i)
+				fpda_push_back(data, i);
+			ankerl::nanobench::doNotOptimizeAway(data);
+			fpda_free_and_null(data);
+		});
+
+		bench.run("fpda_push_back (mmap)", [&] {
+			fp_dynarray(uint64_t) data = fpda_malloc_with_allocator(uint64_t, 1, fp_mmap_allocator(false));
+			for(size_t i = 0; i < count; ++i)
+				fpda_push_back(data, i);
+			ankerl::nanobench::doNotOptimizeAway(data);
+			fpda_free_and_null(data);
+		});
+
+		bench.batch(count / 8).unit("append").run("fp_string append (realloc)", [&] {
+			fp_string data = nullptr;
+			for(size_t i = 0; i < count / 8; ++i)
+				fp_string_view_concatenate_inplace(data, fp_string_view_from_literal("01234567"));
+			ankerl::nanobench::doNotOptimizeAway(data);
+			fp_string_free_and_null(data);
+		});
+	}
+#endif
+
+#ifdef FP_ENABLE_BENCHMARKING
+	TEST_CASE("Find - Benchmark") {
+		constexpr size_t count = 1024 * 1024;
+		fp_dynarray(uint32_t) ids = nullptr;
+		for(size_t i = 0; i < count; ++i)
+			fpda_push_back(ids, (uint32_t)i);
+		uint32_t last = count - 1;
+
+		ankerl::nanobench::Bench bench;
+		bench.title("find in fp_dynarray(uint32_t)").unit("element").batch(count).relative(true).minEpochIterations(10);
+
+		bench.run("memcmp per element", [&] {
+			size_t found = fp_not_found;
+			for(size_t i = 0; i < count; ++i)
+				if(memcmp(ids + i, &last, sizeof(uint32_t)) == 0) { found = i; break; }
+			ankerl::nanobench::doNotOptimizeAway(found);
+		});
+
+		bench.run("fp_find", [&] {
+			ankerl::nanobench::doNotOptimizeAway(fp_find(ids, last));
+		});
+
+		bench.run("fp_rfind", [&] {
+			uint32_t first = 0;
+			ankerl::nanobench::doNotOptimizeAway(fp_rfind(ids, first));
+		});
+
+		fpda_free_and_null(ids);
+	}
+
+	TEST_CASE("String::Find - Benchmark") {
+		std::string log;
+		for(size_t i = 0; log.size() < 8 * 1024 * 1024; ++i)
+			log += "2024-01-01T00:00:" + std::to_string(i % 60) + " INFO request handled path=/api/v1/items/" + std::to_string(i) + "\n";
+		const std::string short_needle = "path=/api/v2", long_needle = "INFO request handled path=/api/v1/items/99999999999";
+		auto haystack = fp_string_view_literal(log.data(), log.size());
+
+		ankerl::nanobench::Bench bench;
+		bench.title("fp_string_view_find (8MiB log, no match)").unit("byte").batch(log.size()).relative(true).minEpochIterations(3);
+
+		auto naive = [](fp_string_view haystack, fp_string_view needle) {
+			for(size_t i = 0; i + fp_view_size(needle) <= fp_view_size(haystack); ++i)
+				if(memcmp(fp_view_data(char, haystack) + i, fp_view_data(char, needle), fp_view_size(needle)) == 0) return i;
+			return fp_not_found;
+		};
+		bench.run("naive (short needle)", [&] {
+			ankerl::nanobench::doNotOptimizeAway(naive(haystack, fp_string_view_literal((char*)short_needle.data(), short_needle.size())));
+		});
+		bench.run("fp_string_view_find (short needle)", [&] {
+			ankerl::nanobench::doNotOptimizeAway(fp_string_view_find(haystack, fp_string_view_literal((char*)short_needle.data(), short_needle.size()), 0));
+		});
+		bench.run("naive (long needle)", [&] {
+			ankerl::nanobench::doNotOptimizeAway(naive(haystack, fp_string_view_literal((char*)long_needle.data(), long_needle.size())));
+		});
+		bench.run("fp_string_view_find (long needle)", [&] {
+			ankerl::nanobench::doNotOptimizeAway(fp_string_view_find(haystack, fp_string_view_literal((char*)long_needle.data(), long_needle.size()), 0));
+		});
+
+		auto short_searcher = fp_string_searcher_create(fp_string_view_literal((char*)short_needle.data(), short_needle.size()));
+		auto long_searcher = fp_string_searcher_create(fp_string_view_literal((char*)long_needle.data(), long_needle.size()));
+		bench.run("fp_string_searcher (short needle)", [&] {
+			ankerl::nanobench::doNotOptimizeAway(fp_string_searcher_find(&short_searcher, haystack, 0));
+		});
+		bench.run("fp_string_searcher (long needle)", [&] {
+			ankerl::nanobench::doNotOptimizeAway(fp_string_searcher_find(&long_searcher, haystack, 0));
+		});
+	}
+
+	TEST_CASE("String::Split - Benchmark") {
+		std::string tsv;
+		for(size_t i = 0; tsv.size() < 8 * 1024 * 1024; ++i)
+			tsv += std::to_string(i) + "\tsome name\t" + std::to_string(i * 31 % 1000) + ".25\tan optional longer comment field\n";
+		auto haystack = fp_string_view_literal(tsv.data(), tsv.size());
+		auto delimiters = fp_string_view_from_literal("\t\n");
+
+		ankerl::nanobench::Bench bench;
+		bench.title("Split (8MiB TSV)").unit("byte").batch(tsv.size()).relative(true).minEpochIterations(3);
+		bench.run("fp_string_view_split", [&] {
+			fp_dynarray(fp_string_view) parts = fp_string_view_split(haystack, delimiters);
+			ankerl::nanobench::doNotOptimizeAway(fpda_size(parts));
+			fpda_free(parts);
+		});
+		bench.run("fp_string_view_split_lazy", [&] {
+			auto it = fp_string_view_split_lazy(haystack, delimiters);
+			fp_string_view piece;
+			size_t count = 0;
+			while(fp_string_split_next(&it, &piece)) ++count;
+			ankerl::nanobench::doNotOptimizeAway(count);
+		});
+		bench.run("fp_csv_parser", [&] {
+			auto csv = fp_csv_parser_create(haystack, '\t', 0);
+			struct fp_csv_field field;
+			size_t count = 0;
+			while(fp_csv_parser_next(&csv, &field)) ++count;
+			ankerl::nanobench::doNotOptimizeAway(count);
+		});
+	}
+
+	TEST_CASE("String::Replace - Benchmark") {
+		std::string page;
+		while(page.size() < 1024 * 1024)
+			page += "<li><a href=\"{{url}}\">{{title}}</a> by {{author}}</li>\n";
+		auto haystack = fp_string_view_literal(page.data(), page.size());
+		auto find = fp_string_view_from_literal("{{title}}");
+
+		ankerl::nanobench::Bench bench;
+		bench.title("Replace all (1MiB template, ~20k matches)").unit("byte").batch(page.size()).relative(true).minEpochIterations(1);
+		for(const char* with : {"A much longer title than the placeholder", "T"}) {
+			auto replacement = fp_string_view_from_literal(with);
+			bench.run(std::string("fp_string_replace_first_inplace loop (") + (strlen(with) > 9 ? "growing)" : "shrinking)"), [&] {
+				fp_string out = fp_string_view_make_dynamic(haystack);
+				for(size_t start = 0; (start = fp_string_replace_first_inplace(&out, find, replacement, start)) != fp_not_found; )
+					start += fp_view_size(replacement);
+				ankerl::nanobench::doNotOptimizeAway(out);
+				fp_string_free(out);
+			});
+			bench.run(std::string("fp_string_replace_inplace (") + (strlen(with) > 9 ? "growing)" : "shrinking)"), [&] {
+				fp_string out = fp_string_view_make_dynamic(haystack);
+				fp_string_replace_inplace(&out, find, replacement, 0);
+				ankerl::nanobench::doNotOptimizeAway(out);
+				fp_string_free(out);
+			});
+			bench.run(std::string("fp_string_view_replace (") + (strlen(with) > 9 ? "growing)" : "shrinking)"), [&] {
+				fp_string out = fp_string_view_replace(haystack, find, replacement, 0);
+				ankerl::nanobench::doNotOptimizeAway(out);
+				fp_string_free(out);
+			});
+		}
+	}
+
+	TEST_CASE("String::Format - Benchmark") {
+		ankerl::nanobench::Bench bench;
+		bench.title("Format 10k lines into one string").unit("line").batch(10000).relative(true).minEpochIterations(10);
+		bench.run("fp_string_format + fp_string_concatenate_inplace", [&] {
+			fp_string out = NULL;
+			for(int i = 0; i < 10000; ++i) {
+				fp_string line = fp_string_format("%d: %s (%.2f)\n", i, "entry", i * 0.5);
+				if(out) fp_string_concatenate_inplace(out, line);
+				else out = fp_string_make_dynamic(line);
+				fp_string_free(line);
+			}
+			ankerl::nanobench::doNotOptimizeAway(out);
+			fp_string_free(out);
+		});
+		bench.run("fp_string_format_append", [&] {
+			fp_string out = NULL;
+			for(int i = 0; i < 10000; ++i)
+				fp_string_format_append(out, "%d: %s (%.2f)\n", i, "entry", i * 0.5);
+			ankerl::nanobench::doNotOptimizeAway(out);
+			fp_string_free(out);
+		});
+	}
+
+	TEST_CASE("String::Aho_Corasick - Benchmark") {
+		std::vector<std::string> words;
+		for(size_t i = 0; i < 1000; ++i)
+			words.push_back("keyword" + std::to_string(i * 7919 % 100000) + ";");
+		std::string text;
+		for(size_t i = 0; text.size() < 1024 * 1024; ++i)
+			text += (i % 16 == 0 ? words[i % words.size()] : "plain text between the keywords ") + std::string(" ");
+		fp_dynarray(fp_string_view) keywords = NULL;
+		for(auto& word: words) fpda_push_back(keywords, fp_string_view_literal(word.data(), word.size()));
+		std::vector<fp_string_view> with(words.size(), fp_string_view_from_literal("***"));
+		auto haystack = fp_string_view_literal(text.data(), text.size());
+
+		ankerl::nanobench::Bench bench;
+		bench.title("Replace 1000 keywords (1MiB text)").unit("byte").batch(text.size()).relative(true).minEpochIterations(1);
+		bench.run("fp_string_replace_inplace per keyword", [&] {
+			fp_string out = fp_string_view_make_dynamic(haystack);
+			for(size_t i = 0; i < words.size(); ++i)
+				fp_string_replace_inplace(&out, keywords[i], with[i], 0);
+			ankerl::nanobench::doNotOptimizeAway(out);
+			fp_string_free(out);
+		});
+		auto ac = fp_aho_corasick_create(keywords);
+		bench.run("fp_string_view_replace_all_multi", [&] {
+			fp_string out = fp_string_view_replace_all_multi(haystack, &ac, with.data());
+			ankerl::nanobench::doNotOptimizeAway(out);
+			fp_string_free(out);
+		});
+
+		fp_aho_corasick_free(&ac);
+		fpda_free_and_null(keywords);
+	}
+
+	TEST_CASE("UTF8 - Benchmark") {
+		std::string text;
+		while(text.size() < 8 * 1024 * 1024)
+			text += "The quick brown fox jumps over the lazy dog. Größe, naïve café — 世界 🌍\n";
+		auto haystack = fp_string_view_literal(text.data(), text.size());
+
+		ankerl::nanobench::Bench bench;
+		bench.title("UTF-8 decode (8MiB, mostly ASCII)").unit("byte").batch(text.size()).relative(true).minEpochIterations(3);
+		bench.run("per codepoint fpda_push_back", [&] {
+			fp_dynarray(uint32_t) out = nullptr;
+			const uint8_t* s = fp_view_data(uint8_t, haystack);
+			for(size_t i = 0; i < text.size(); ) {
+				uint32_t codepoint;
+				i += __fp_utf8_decode_one(s + i, text.size() - i, &codepoint);
+				fpda_push_back(out, codepoint);
+			}
+			ankerl::nanobench::doNotOptimizeAway(out);
+			fpda_free(out);
+		});
+		bench.run("fp_string_view_to_codepoints", [&] {
+			fp_dynarray(uint32_t) out = fp_string_view_to_codepoints(haystack);
+			ankerl::nanobench::doNotOptimizeAway(out);
+			fpda_free(out);
+		});
+
+		fp_dynarray(uint32_t) codepoints = fp_string_view_to_codepoints(haystack);
+		auto codepoint_view = fp_view_make_full(uint32_t, codepoints);
+		ankerl::nanobench::Bench encode;
+		encode.title("UTF-8 encode (8MiB, mostly ASCII)").unit("codepoint").batch(fpda_size(codepoints)).relative(true).minEpochIterations(3);
+		encode.run("fp_encode_utf8 + fp_string_append", [&] {
+			fp_string out = nullptr;
+			fpda_reserve(out, fpda_size(codepoints));
+			for(size_t i = 0; i < fpda_size(codepoints); ++i) {
+				char temp[4];
+				size_t len = fp_encode_utf8(codepoints[i], temp);
+				for(size_t j = 0; j < len; ++j)
+					fp_string_append(out, temp[j]);
+			}
+			ankerl::nanobench::doNotOptimizeAway(out);
+			fp_string_free(out);
+		});
+		encode.run("fp_codepoints_view_to_string", [&] {
+			fp_string out = fp_codepoints_view_to_string(codepoint_view);
+			ankerl::nanobench::doNotOptimizeAway(out);
+			fp_string_free(out);
+		});
+		fpda_free(codepoints);
+	}
+
+	TEST_CASE("Hashtable - Benchmark") {
+		constexpr size_t count = 1 << 16;
+		std::vector<uint64_t> keys(count), missing(count);
+		uint64_t seed = 42;
+		auto random = [&] { seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17; return seed; };
+		for(size_t i = 0; i < count; ++i) {
+			keys[i] = random() | 1;
+			missing[i] = keys[i] & ~uint64_t(1);
+		}
+
+		ankerl::nanobench::Bench build;
+		build.title("Hash table insert (64k uint64_t)").unit("insert").batch(count).minEpochIterations(5);
+		build.run("fpht_insert", [&] {
+			fp_hashtable(uint64_t) table = fp_create_default_hash_table(uint64_t);
+			for(size_t i = 0; i < count; ++i)
+				fpht_insert(table, keys[i]);
+			ankerl::nanobench::doNotOptimizeAway(table);
+			fpht_free_and_null(table);
+		});
+
+		build.run("fpht_reserve + fpht_insert", [&] {
+			fp_hashtable(uint64_t) table = fp_create_default_hash_table(uint64_t);
+			fpht_reserve(table, count);
+			for(size_t i = 0; i < count; ++i)
+				fpht_insert(table, keys[i]);
+			ankerl::nanobench::doNotOptimizeAway(table);
+			fpht_free_and_null(table);
+		});
+
+		auto swiss = fpht_default_config();
+		swiss.engine = FP_HASH_TABLE_ENGINE_SWISS;
+		build.run("fpht_insert (swiss)", [&] {
+			fp_hashtable(uint64_t) table = fp_create_hash_table(uint64_t, swiss);
+			for(size_t i = 0; i < count; ++i)
+				fpht_insert(table, keys[i]);
+			ankerl::nanobench::doNotOptimizeAway(table);
+			fpht_free_and_null(table);
+		});
+
+		ankerl::nanobench::Bench lookup;
+		lookup.title("Hash table lookup (64k uint64_t)").unit("lookup").batch(count).minEpochIterations(20);
+		for(auto config: {fpht_default_config(), swiss}) {
+			std::string engine = config.engine == FP_HASH_TABLE_ENGINE_SWISS ? "swiss" : "hopscotch";
+			fp_hashtable(uint64_t) table = fp_create_hash_table(uint64_t, config);
+			for(size_t i = 0; i < count; ++i)
+				fpht_insert(table, keys[i]);
+			lookup.run("fpht_find (hits, " + engine + ")", [&] {
+				size_t found = 0;
+				for(size_t i = 0; i < count; ++i)
+					found += fpht_find(table, keys[i]) != nullptr;
+				ankerl::nanobench::doNotOptimizeAway(found);
+			});
+			lookup.run("fpht_find (misses, " + engine + ")", [&] {
+				size_t found = 0;
+				for(size_t i = 0; i < count; ++i)
+					found += fpht_find(table, missing[i]) != nullptr;
+				ankerl::nanobench::doNotOptimizeAway(found);
+			});
+			fpht_free_and_null(table);
+		}
+	}
+
+	TEST_CASE("Hashtable - Stored hashes Benchmark") {
+		// Long string keys, hashing and comparing them is most of the cost of a table
+		constexpr size_t count = 1 << 14;
+		std::vector<std::string> strings(count);
+		std::vector<const char*> keys(count);
+		for(size_t i = 0; i < count; ++i) {
+			strings[i] = std::string(256, 'x') + std::to_string(i);
+			keys[i] = strings[i].c_str();
+		}
+		auto config = fpht_default_config();
+		config.hash_function = [](const fp_void_view key) noexcept {
+			const char* string = *(const char**)fp_view_data_void(key);
+			return fp_fnv1a_hash(fp_view_literal(uint8_t, (uint8_t*)string, strlen(string)));
+		};
+		config.compare_function = [](const fp_void_view a, const fp_void_view b) noexcept {
+			return strcmp(*(const char**)fp_view_data_void(a), *(const char**)fp_view_data_void(b)) == 0;
+		};
+
+		ankerl::nanobench::Bench bench;
+		bench.title("Hash table of 16k long strings").unit("key").batch(count).minEpochIterations(5);
+		for(auto engine: {FP_HASH_TABLE_ENGINE_HOPSCOTCH, FP_HASH_TABLE_ENGINE_SWISS})
+			for(bool store: {false, true}) {
+				config.engine = engine;
+				config.store_hashes = store;
+				std::string name = std::string(engine == FP_HASH_TABLE_ENGINE_SWISS ? "swiss" : "hopscotch") + (store ? ", stored hashes" : "");
+				bench.run("fpht_insert (" + name + ")", [&] {
+					fp_hashtable(const char*) table = fp_create_hash_table(const char*, config);
+					for(size_t i = 0; i < count; ++i)
+						fpht_insert(table, keys[i]);
+					ankerl::nanobench::doNotOptimizeAway(table);
+					fpht_free_and_null(table);
+				});
+
+				fp_hashtable(const char*) table = fp_create_hash_table(const char*, config);
+				for(size_t i = 0; i < count; ++i)
+					fpht_insert(table, keys[i]);
+				bench.run("fpht_rehash (" + name + ")", [&] {
+					fpht_rehash(table);
+					ankerl::nanobench::doNotOptimizeAway(table);
+				});
+				fpht_free_and_null(table);
+			}
+	}
+
+	TEST_CASE("Pool - Churn Benchmark") {
+		constexpr size_t count = 100000;
+		fp_pool* pool = fp_pool_create();
+
+		auto churn = [](const fp_allocator* allocator) {
+			fp_dynarray(fp_dynarray(int)) live = fpda_malloc_with_allocator(fp_dynarray(int), 64, allocator);
+			for(size_t i = 0; i < count; ++i) {
+				fp_dynarray(int) small = fpda_malloc_with_allocator(int, 4, allocator);
+				for(int j = 0; j < int(i % 32); ++j)
+					fpda_push_back(small, j);
+				if(fpda_size(live) == 64) {
+					size_t victim = i % 64;
+					fpda_free(live[victim]);
+					live[victim] = small;
+				} else fpda_push_back(live, small);
+			}
+			ankerl::nanobench::doNotOptimizeAway(live);
+			for(size_t i = 0; i < fpda_size(live); ++i)
+				fpda_free(live[i]);
+			fpda_free(live);
+		};
+
+		ankerl::nanobench::Bench bench;
+		bench.title("small dynarray churn").unit("dynarray").batch(count).relative(true);
+		bench.run("default (realloc)", [&] { churn(nullptr); });
+		bench.run("pool", [&] { churn(fp_pool_allocator(pool)); });
+		fp_pool_release(pool);
+	}
+#endif
+
 #if !(defined _MSC_VER || defined __APPLE__)
 	TEST_CASE("C") {
 		check_stack();
 		check_heap();
+		check_allocator();
 		check_view();
 		check_dynarray();
 		check_string();
@@ -7,6 +7,11 @@
 #include <fp/dynarray.hpp>
 #include <fp/string.hpp>
 #include <fp/hash.hpp>
+#include <fp/arena.hpp>
+#include <fp/pool.hpp>
+#include <fp/mmap.hpp>
+#include <fp/aho_corasick.hpp>
+#include <fp/csv.hpp>
 
 TEST_SUITE("LibFP::C++") {
 
@@ -77,6 +82,108 @@ TEST_SUITE("LibFP::C++") {
 		CHECK(arr[20] == 6);
 	}
 
+	TEST_CASE("Allocator") {
+		size_t live = 0;
+		fp_allocator counting = {
+			[](void* state, size_t size) noexcept -> void* { ++*(size_t*)state; return std::malloc(size); },
+			nullptr,
+			[](void* state, void* p, size_t) noexcept { --*(size_t*)state; std::free(p); },
+			&live
+		};
+
+		{
+			fp::auto_free arr = fp::malloc<int>(20, &counting);
+			arr.realloc(40);
+			CHECK(arr.length() == 40);
+			CHECK(live == 1);
+
+			fp::raii::dynarray<int> da = fp::dynarray<int>::with_allocator(&counting);
+			for(int i = 0; i < 100; i++)
+				da.push_back(i);
+			CHECK(da.allocator() == &counting);
+			CHECK(da[99] == 99);
+			CHECK(live == 2);
+		}
+		CHECK(live == 0);
+	}
+
+	TEST_CASE("Aligned") {
+		fp::raii::dynarray<float, 32> samples;
+		for(int i = 0; i < 1000; i++)
+			samples.push_back(i);
+		CHECK(((uintptr_t)samples.data()) % 32 == 0);
+		CHECK(samples[999] == 999);
+
+		fp::raii::dynarray<float, 32> copy = samples.clone();
+		CHECK(((uintptr_t)copy.data()) % 32 == 0);
+
+		fp::auto_free buffer = fp::malloc_aligned<uint8_t, 64>(100);
+		CHECK(((uintptr_t)buffer.data()) % 64 == 0);
+		CHECK(buffer.length() == 100);
+	}
+
+	TEST_CASE("Pool") {
+		fp::pool pool;
+		{
+			auto scope = pool.make_current();
+			fp::raii::dynarray<int> arr;
+			arr.push_back(1);
+			CHECK(arr.allocator() == pool.allocator());
+		}
+		{
+			auto scope = fp::pool::make_thread_current();
+			fp::raii::string str = fp::raii::string{"Hello"};
+			CHECK(str.allocator() == fp_pool_thread_allocator());
+		}
+		CHECK(fp_thread_allocator() == nullptr);
+		fp_pool_release_thread();
+	}
+
+	TEST_CASE("Mapped File") {
+		const char* path = "fp_mapped_view.test";
+		FILE* file = fopen(path, "wb");
+		REQUIRE(file);
+		fputs("Hello World", file);
+		fclose(file);
+
+		{
+			fp::mapped_view<char> mapped(path);
+			CHECK(mapped.is_open());
+			CHECK(mapped.size() == 11);
+			CHECK(std::string_view(mapped.data(), mapped.size()) == "Hello World");
+			CHECK(mapped.view(6, 5).size() == 5);
+
+			fp::mapped_view<char> moved = std::move(mapped);
+			CHECK(!mapped.is_open());
+			CHECK(moved.back() == 'd');
+		}
+		CHECK(!fp::mapped_view<char>("fp_mapped_view.missing").is_open());
+		remove(path);
+	}
+
+	TEST_CASE("Arena") {
+		fp::arena arena;
+		{
+			auto scope = arena.make_current();
+			fp::raii::dynarray<int> arr;
+			for(int i = 0; i < 100; i++)
+				arr.push_back(i);
+			CHECK(arr.allocator() == arena.allocator());
+			CHECK(arr[99] == 99);
+
+			auto str = fp::raii::string{"Hello"};
+			CHECK(str.allocator() == arena.allocator());
+		}
+		CHECK(fp_thread_allocator() == nullptr);
+
+		fp::raii::dynarray<int> outside;
+		outside.push_back(1);
+		CHECK(outside.allocator() == nullptr);
+
+		arena.reset();
+		CHECK(arena.used() == 0);
+	}
+
     TEST_CASE("View") {
 		fp::array<int, 20> arr = {};
 		arr[10] = 6;
@@ -195,6 +302,10 @@ TEST_SUITE("LibFP::C++") {
 #endif
 		auto fmt2 = fp::string::format("{} {}{}\n", "Hello", "World", '!').auto_free();
 		CHECK(fmt2 == "Hello World!\n");
+		fmt2.format_append("{}={}", "answer", 42);
+		CHECK(fmt2 == "Hello World!\nanswer=42");
+		CHECK(fmt2.data()[fmt2.size()] == 0);
+		CHECK(fp::string::format("{}", "").raw == nullptr);
 
 		auto repl = str.replicate(5).auto_free();
 		CHECK(repl == "Hello WorldHello WorldHello WorldHello WorldHello World");
@@ -211,6 +322,70 @@ TEST_SUITE("LibFP::C++") {
 		CHECK(!replaced.ends_with("World"));
 	}
 
+	TEST_CASE("String::Searcher") {
+		fp::string_searcher token("ball");
+		auto str = fp::raii::string{"ball"}.replicate(3).auto_free();
+		CHECK(token.find(str.full_view()) == 0);
+		CHECK(token.find(str.full_view(), 1) == 4);
+		CHECK(token.contains("a football"));
+		CHECK(token.count(str.full_view()) == 3);
+
+		fp::raii::dynarray<size_t> hits = token.find_all(str.full_view());
+		CHECK(hits.size() == 3);
+		CHECK(hits[2] == 8);
+		token.find_all("ball", hits);
+		CHECK(hits.size() == 4);
+	}
+
+	TEST_CASE("String::Split") {
+		fp::string_view csv = "a,b,,c";
+		auto eager = csv.split(",");
+		size_t i = 0;
+		for(fp::string_view field: csv.split_lazy(","))
+			CHECK(field == eager[i++]);
+		CHECK(i == 4);
+		eager.free();
+
+		fp::raii::string line = fp::raii::string{"x y"};
+		size_t count = 0;
+		for(auto field: line.split_lazy(" ")) count += field.size();
+		CHECK(count == 2);
+	}
+
+	TEST_CASE("String::CSV") {
+		fp::csv_parser csv("a,\"b \"\"c\"\"\"\n1,2\n");
+		fp::raii::dynarray<fp::string_view> fields;
+		REQUIRE(csv.next_record(fields));
+		CHECK(fields.size() == 2);
+		auto unescaped = csv.unescape(fields[1]).auto_free();
+		CHECK(unescaped == "b \"c\"");
+		REQUIRE(csv.next_record(fields));
+		CHECK(fields[1] == "2");
+		CHECK(!csv.next_record(fields));
+	}
+
+	TEST_CASE("String::Aho_Corasick") {
+		fp::raii::dynarray<fp::string_view> keywords;
+		keywords.push_back("he");
+		keywords.push_back("she");
+		keywords.push_back("hers");
+		fp::aho_corasick ac(keywords);
+		CHECK(ac.pattern_count() == 3);
+		CHECK(ac.contains("ushers"));
+		CHECK(ac.find("ushers")->pattern == 1);
+		CHECK(!ac.find("ushers", 4));
+		CHECK(ac.count("ushers") == 3);
+
+		fp::raii::dynarray<fp::aho_corasick_match> hits = ac.find_all("ushers");
+		CHECK(hits.size() == 3);
+		ac.find_all("the", hits);
+		CHECK(hits.size() == 4);
+
+		fp::string_view with[] = {"1", "2", "3"};
+		auto replaced = ac.replace_all("ushers and hers", with).auto_free();
+		CHECK(replaced == "u2rs and 3");
+	}
+
 	TEST_CASE("String::Equal_Replace") {
 		auto str = fp::raii::string{"ball"}.replicate(5).auto_free();
 		auto replaced = str.replace("ball", "look", 0).auto_free();
@@ -228,6 +403,23 @@ TEST_SUITE("LibFP::C++") {
 		CHECK(utf8 == "Hello, 世界");
 	}
 
+	TEST_CASE("UTF8::View") {
+		fp::string_view text = "h\xC3\xA9llo w\xC3\xB6rld";
+		CHECK(text.codepoint_count() == 11);
+		CHECK(text.codepoint_offset(2) == 3);
+		CHECK(text.codepoint_index(3) == 2);
+		size_t count = 0;
+		for(uint32_t codepoint: text.codepoints())
+			count += codepoint > 0x7F;
+		CHECK(count == 2);
+		CHECK(text.grapheme_subview(6, 5) == "w\xC3\xB6rld");
+
+		fp::utf8_index index(text, 4);
+		CHECK(index.size() == 11);
+		CHECK(index.offset(8) == 10);
+		CHECK(index.codepoint(9) == 7); // Inside ö
+	}
+
 	TEST_CASE("Hashtable") {
 		fp::auto_free table = fp::hash_table<int>::create();
 		CHECK(table.raw != nullptr);
@@ -236,7 +428,7 @@ TEST_SUITE("LibFP::C++") {
 		CHECK(table.insert(5, true) == 5);
 
 		auto p = table.find_position(5);
-		CHECK(p == 6);
+		CHECK(p == 2);
 		CHECK(table[p] == 5);
 		auto v = table.find(5);
 		CHECK(*v == 5);
@@ -260,6 +452,33 @@ TEST_SUITE("LibFP::C++") {
 		CHECK(table.find(5) == nullptr);
 	}
 
+	TEST_CASE("Hashtable - Swiss") {
+		fp::hash_table<int>::config config;
+		config.engine = FP_HASH_TABLE_ENGINE_SWISS;
+		fp::auto_free table = fp::hash_table<int>::create(config);
+		bool inserted = true;
+		for(int i = 0; i < 1000; ++i)
+			inserted &= table.insert(i) == i;
+		CHECK(inserted);
+		CHECK(*table.find(500) == 500);
+		CHECK(table.find(1000) == nullptr);
+		table.remove(500);
+		CHECK(!table.contains(500));
+		CHECK(table.contains(501));
+	}
+
+	TEST_CASE("Hashtable - Stored hashes") {
+		fp::hash_table<int>::config config;
+		config.store_hashes = true;
+		fp::auto_free table = fp::hash_table<int>::create(config);
+		for(int i = 0; i < 1000; ++i)
+			table.insert(i);
+		REQUIRE(table.double_size_and_rehash() == fp_not_found);
+		CHECK(table.occupied_size() == 1000);
+		CHECK(*table.find(500) == 500);
+		CHECK(table.find(1000) == nullptr);
+	}
+
 	TEST_CASE("Hashmap") {
 		fp::hash_map<fp::raii::string, int> map;
 		for(size_t i = 0; i < 100; ++i)